@@ -0,0 +1,79 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json-schema.hpp>
+
+// Per-value cost of the checks of the default format-checker, as bound to the
+// format-keywords of a schema, for a few valid and an invalid value of each format.
+// The failures are returned as status, of which the message is built for the last
+// column - as it is when the error is reported. Pass the number of rounds to change it.
+
+struct format_values {
+	const char *format;
+	std::vector<std::string> valid, invalid;
+};
+
+// ns per value, or -1 if a value was not checked as expected
+static double time_per_value(const char *format, const std::vector<std::string> &values, bool valid, bool message, long rounds)
+{
+	auto check = nlohmann::json_schema::default_string_format(format);
+
+	auto start = std::chrono::steady_clock::now();
+	for (long i = 0; i < rounds; i++)
+		for (auto &value : values) {
+			auto status = check.check(value);
+			if (status.ok() != valid)
+				return -1;
+			if (message && status.message().empty())
+				return -1;
+		}
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / (rounds * values.size());
+}
+
+static const std::vector<format_values> formats = {
+    {"date-time", {"1985-04-12T23:20:50.52Z", "1990-12-31T15:59:60-08:00"}, {"1985-04-12T24:00:00Z"}},
+    {"date", {"2019-07-04", "2020-02-29"}, {"2019-02-29"}},
+    {"time", {"23:20:50.52Z", "15:59:60-08:00"}, {"24:00:00Z"}},
+    {"email", {"john.doe@example.com", "\"quoted\"@example.com"}, {"john.doe@"}},
+    {"hostname", {"www.example.com", "a-b.c1.example"}, {"-invalid.example"}},
+    {"idn-hostname", {"\xec\x8b\xa4\xeb\xa1\x80.\xed\x85\x8c\xec\x8a\xa4\xed\x8a\xb8", "xn--ihqwcrb4cv8a8dqg056pqjye"}, {"l\xc2\xb7" "a"}},
+    {"ipv4", {"192.168.0.1", "255.255.255.255"}, {"256.0.0.1"}},
+    {"ipv6", {"2001:db8:85a3::8a2e:370:7334", "::ffff:192.168.0.1"}, {"1::2::3"}},
+    {"uri", {"https://john.doe@www.example.com:123/forum/questions/?tag=networking&order=newest#top", "urn:isbn:0451450523"}, {"www.example.com"}},
+    {"uri-reference", {"//www.example.com/search?q=x", "../a/b#c"}, {"#frag\\ment"}},
+    {"iri", {"http://\xc6\x92\xc3\xb8\xc3\xb8.\xc3\x9f\xc3\xa5r/?\xe2\x88\x82=\xcf\x80#\xcf\x80", "mailto:a@example.com"}, {"/abc"}},
+    {"iri-reference", {"/\xc3\xa2\xcf\x80", "#\xc6\x92r\xc3\xa4g"}, {"\\\\WINDOWS\\share"}},
+    {"uri-template", {"http://example.com/dictionary/{term:1}/{term}", "{+path*}/here{?x,y}"}, {"{term"}},
+    {"json-pointer", {"/foo/bar~0/baz~1/%a", ""}, {"/foo/bar~"}},
+    {"relative-json-pointer", {"2/0/baz/1/zip", "0#"}, {"01#"}},
+    {"uuid", {"2eb8aa08-aa98-11ea-b4aa-73b441d16380", "2EB8AA08-AA98-11EA-B4AA-73B441D16380"}, {"2eb8aa08-aa98-11ea-b4aa-73b441d1638"}},
+    {"regex", {"^[a-z]+$", "(a|b)*c"}, {"(a"}},
+};
+
+int main(int argc, char *argv[])
+{
+	const long rounds = argc > 1 ? std::stol(argv[1]) : 100000;
+
+	std::cout << std::left << std::setw(24) << "format" << std::setw(16) << "ns/valid value"
+	          << std::setw(18) << "ns/invalid value"
+	          << "with message\n";
+
+	for (auto &f : formats) {
+		auto valid = time_per_value(f.format, f.valid, true, false, rounds);
+		auto invalid = time_per_value(f.format, f.invalid, false, false, rounds);
+		auto message = time_per_value(f.format, f.invalid, false, true, rounds);
+		if (valid < 0 || invalid < 0 || message < 0) {
+			std::cerr << f.format << ": a value was not checked as expected\n";
+			return EXIT_FAILURE;
+		}
+
+		std::cout << std::left << std::setw(24) << f.format << std::fixed << std::setprecision(1)
+		          << std::setw(16) << valid << std::setw(18) << invalid << message << "\n";
+	}
+
+	return EXIT_SUCCESS;
+}
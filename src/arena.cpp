@@ -0,0 +1,50 @@
+#include "arena.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace nlohmann
+{
+namespace json_schema
+{
+
+void *arena::allocate_chunk(std::size_t size, std::size_t align)
+{
+	// chunks grow up to 1 MiB, larger requests get a chunk of their own
+	auto header = (sizeof(chunk) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+	auto capacity = std::max(next_chunk_size_, size + align);
+	next_chunk_size_ = std::min<std::size_t>(next_chunk_size_ * 2, 1024 * 1024);
+
+	auto memory = static_cast<char *>(std::malloc(header + capacity));
+	if (!memory)
+		throw std::bad_alloc();
+
+	auto c = reinterpret_cast<chunk *>(memory);
+	c->next = chunks_;
+	chunks_ = c;
+
+	current_ = memory + header;
+	end_ = current_ + capacity;
+	return allocate(size, align);
+}
+
+void arena::clear()
+{
+	for (auto f = finalizers_; f;) {
+		auto next = f->next;
+		f->destroy(f->object);
+		f = next;
+	}
+	finalizers_ = nullptr;
+
+	for (auto c = chunks_; c;) {
+		auto next = c->next;
+		std::free(c);
+		c = next;
+	}
+	chunks_ = nullptr;
+	current_ = end_ = nullptr;
+}
+
+} // namespace json_schema
+} // namespace nlohmann
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace nlohmann
+{
+namespace json_schema
+{
+
+// Monotonic memory resource: allocations are carved from large chunks and are
+// only given back all at once by clear() or the destructor. Objects created
+// with make() are destroyed there as well, in reverse order of their creation.
+class arena
+{
+	struct chunk {
+		chunk *next;
+	};
+
+	struct finalizer {
+		void (*destroy)(void *);
+		void *object;
+		finalizer *next;
+	};
+
+	chunk *chunks_ = nullptr;
+	finalizer *finalizers_ = nullptr;
+	char *current_ = nullptr;
+	char *end_ = nullptr;
+	std::size_t next_chunk_size_;
+
+	void *allocate_chunk(std::size_t size, std::size_t align);
+
+	template <typename T>
+	static void destroy(void *object)
+	{
+		static_cast<T *>(object)->~T();
+	}
+
+public:
+	explicit arena(std::size_t initial_chunk_size = 16 * 1024)
+	    : next_chunk_size_(initial_chunk_size) {}
+	~arena() { clear(); }
+
+	arena(const arena &) = delete;
+	arena &operator=(const arena &) = delete;
+
+	void *allocate(std::size_t size, std::size_t align)
+	{
+		auto space = static_cast<std::size_t>(end_ - current_);
+		auto padding = (align - reinterpret_cast<std::size_t>(current_) % align) % align;
+		if (current_ && padding + size <= space) {
+			void *p = current_ + padding;
+			current_ += padding + size;
+			return p;
+		}
+		return allocate_chunk(size, align);
+	}
+
+	template <typename T, typename... Args>
+	T *make(Args &&...args)
+	{
+		finalizer *f = nullptr;
+		if (!std::is_trivially_destructible<T>::value)
+			f = static_cast<finalizer *>(allocate(sizeof(finalizer), alignof(finalizer)));
+
+		auto object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+
+		if (f) {
+			f->destroy = &arena::destroy<T>;
+			f->object = object;
+			f->next = finalizers_;
+			finalizers_ = f;
+		}
+		return object;
+	}
+
+	// destroys all objects created by make() and frees all memory
+	void clear();
+};
+
+// STL-allocator for containers whose memory lives in an arena
+template <typename T>
+class arena_allocator
+{
+	template <typename U>
+	friend class arena_allocator;
+
+	arena *arena_;
+
+public:
+	typedef T value_type;
+
+	arena_allocator(arena &a) noexcept
+	    : arena_(&a) {}
+
+	template <typename U>
+	arena_allocator(const arena_allocator<U> &other) noexcept
+	    : arena_(other.arena_) {}
+
+	T *allocate(std::size_t n) { return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T))); }
+	void deallocate(T *, std::size_t) noexcept {}
+
+	template <typename U>
+	bool operator==(const arena_allocator<U> &other) const { return arena_ == other.arena_; }
+	template <typename U>
+	bool operator!=(const arena_allocator<U> &other) const { return arena_ != other.arena_; }
+};
+
+} // namespace json_schema
+} // namespace nlohmann
@@ -0,0 +1,117 @@
+#include "format-cache.hpp"
+
+#include <cstring>
+#include <functional>
+
+namespace nlohmann
+{
+namespace json_schema
+{
+
+format_cache::format_cache(std::size_t entries, std::size_t formats)
+    : shards_(new std::mutex[shard_count]),
+      counters_(new counters[formats])
+{
+	std::size_t sets = 1;
+	while (sets * ways < entries)
+		sets *= 2;
+	set_mask_ = sets - 1;
+	sets_.reset(new set[sets]);
+
+	for (std::size_t i = 0; i < sets; i++)
+		for (auto &s : sets_[i].slots)
+			for (auto &word : s.value)
+				word.store(0, std::memory_order_relaxed);
+}
+
+format_cache::key format_cache::key_of(std::size_t format, std::string_view value)
+{
+	key k{};
+	std::memcpy(k.value, value.data(), value.size());
+	k.hash = std::hash<std::string_view>()(value) ^ ((format + 1) * 0x9e3779b97f4a7c15ull);
+	if (k.hash == 0)
+		k.hash = 1;
+	return k;
+}
+
+bool format_cache::holds(const slot &s, std::size_t format, std::string_view value, const key &k)
+{
+	if (s.hash.load(std::memory_order_relaxed) != k.hash || s.format.load(std::memory_order_relaxed) != format ||
+	    s.size.load(std::memory_order_relaxed) != value.size())
+		return false;
+	for (std::size_t i = 0; i < (value.size() + 7) / 8; i++)
+		if (s.value[i].load(std::memory_order_relaxed) != k.value[i])
+			return false;
+	return true;
+}
+
+bool format_cache::find(std::size_t format, std::string_view value, int &code) const
+{
+	if (value.size() > max_value_size)
+		return false;
+
+	auto k = key_of(format, value);
+	auto &candidates = sets_[k.hash & set_mask_];
+
+	for (auto &s : candidates.slots) {
+		auto sequence = s.sequence.load(std::memory_order_acquire);
+		if (sequence & 1)
+			continue;
+
+		bool found = holds(s, format, value, k);
+		int result = s.code.load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (!found || s.sequence.load(std::memory_order_relaxed) != sequence)
+			continue;
+
+		if (!s.referenced.load(std::memory_order_relaxed))
+			s.referenced.store(true, std::memory_order_relaxed);
+		code = result;
+		return true;
+	}
+	return false;
+}
+
+void format_cache::insert(std::size_t format, std::string_view value, int code)
+{
+	if (value.size() > max_value_size)
+		return;
+
+	auto k = key_of(format, value);
+	auto index = k.hash & set_mask_;
+	auto &candidates = sets_[index];
+
+	std::lock_guard<std::mutex> lock(shards_[index % shard_count]);
+
+	slot *victim = nullptr;
+	for (auto &s : candidates.slots)
+		if (holds(s, format, value, k))
+			victim = &s; // inserted by another thread meanwhile
+
+	while (!victim) {
+		auto &s = candidates.slots[candidates.hand];
+		candidates.hand = (candidates.hand + 1) % ways;
+		if (s.hash.load(std::memory_order_relaxed) == 0 || !s.referenced.load(std::memory_order_relaxed))
+			victim = &s;
+		else
+			s.referenced.store(false, std::memory_order_relaxed);
+	}
+
+	auto sequence = victim->sequence.load(std::memory_order_relaxed);
+	victim->sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	victim->hash.store(k.hash, std::memory_order_relaxed);
+	victim->format.store(static_cast<std::uint32_t>(format), std::memory_order_relaxed);
+	victim->size.store(static_cast<std::uint32_t>(value.size()), std::memory_order_relaxed);
+	victim->code.store(code, std::memory_order_relaxed);
+	for (std::size_t i = 0; i < words; i++)
+		victim->value[i].store(k.value[i], std::memory_order_relaxed);
+	victim->referenced.store(false, std::memory_order_relaxed);
+
+	victim->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+} // namespace json_schema
+} // namespace nlohmann
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+namespace nlohmann
+{
+namespace json_schema
+{
+
+// Outcomes of format-checks of recently checked values, keyed by the id of the
+// format and the value, for values of up to max_value_size bytes.
+//
+// Lookups do not lock: each slot has a sequence number which is odd while the
+// slot is written, readers which see it change take it for a miss. Values are
+// kept in sets of 4 slots, of which the one to replace is chosen by CLOCK - an
+// approximation of least-recently-used; the sets are split into shards, each
+// with a lock for the writers.
+class format_cache
+{
+public:
+	static const std::size_t max_value_size = 64;
+
+	struct counters {
+		std::atomic<std::uint64_t> hits{0}, misses{0};
+	};
+
+	format_cache(std::size_t entries, std::size_t formats);
+
+	format_cache(const format_cache &) = delete;
+	format_cache &operator=(const format_cache &) = delete;
+
+	// the code of the remembered check of value, false if there is none
+	bool find(std::size_t format, std::string_view value, int &code) const;
+	void insert(std::size_t format, std::string_view value, int code);
+
+	counters &of(std::size_t format) const { return counters_[format]; }
+
+private:
+	static const std::size_t ways = 4, shard_count = 16, words = max_value_size / 8;
+
+	struct slot {
+		std::atomic<std::uint32_t> sequence{0};
+		std::atomic<bool> referenced{false};
+		std::atomic<std::uint64_t> hash{0}; // 0 while empty
+		std::atomic<std::uint32_t> format{0}, size{0};
+		std::atomic<int> code{0};
+		std::atomic<std::uint64_t> value[words];
+	};
+
+	struct set {
+		slot slots[ways];
+		std::size_t hand = 0; // of CLOCK, guarded by the lock of the shard
+	};
+
+	std::size_t set_mask_;
+	std::unique_ptr<set[]> sets_;
+	std::unique_ptr<std::mutex[]> shards_;
+	std::unique_ptr<counters[]> counters_;
+
+	struct key {
+		std::uint64_t hash;
+		std::uint64_t value[words];
+	};
+	static key key_of(std::size_t format, std::string_view value);
+	static bool holds(const slot &s, std::size_t format, std::string_view value, const key &k);
+};
+
+} // namespace json_schema
+} // namespace nlohmann
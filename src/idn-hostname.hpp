@@ -0,0 +1,15 @@
+#pragma once
+
+namespace nlohmann
+{
+namespace json_schema
+{
+
+// whether [p, end) is an internationalized hostname: dot-separated labels which
+// are LDH-labels, A-labels ("xn--" and Punycode) or UTF-8 U-labels, by the label
+// rules of RFC 5891 and the exceptions and contextual rules of RFC 5892 - the
+// derived property table of RFC 5892 and the Bidi rule of RFC 5893 are not applied
+bool is_idn_hostname(const char *p, const char *end);
+
+} // namespace json_schema
+} // namespace nlohmann
@@ -0,0 +1,89 @@
+#include "json-hash.hpp"
+
+#include <functional>
+#include <unordered_set>
+
+namespace nlohmann
+{
+namespace json_schema
+{
+
+namespace
+{
+
+std::size_t combine(std::size_t seed, std::size_t h)
+{
+	return seed ^ (h + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+} // namespace
+
+std::size_t json_hash(const json &value)
+{
+	std::size_t seed = static_cast<std::size_t>(value.type());
+
+	switch (value.type()) {
+	case json::value_t::null:
+	case json::value_t::discarded:
+		break;
+
+	case json::value_t::boolean:
+		seed = combine(seed, value.get<bool>());
+		break;
+
+	case json::value_t::number_integer:
+	case json::value_t::number_unsigned:
+	case json::value_t::number_float: {
+		// all numbers compare by their floating point value
+		seed = static_cast<std::size_t>(json::value_t::number_float);
+		auto number = value.get<json::number_float_t>();
+		if (number == 0) // -0.0 == 0.0
+			number = 0;
+		seed = combine(seed, std::hash<json::number_float_t>()(number));
+	} break;
+
+	case json::value_t::string:
+		seed = combine(seed, std::hash<std::string>()(value.get_ref<const json::string_t &>()));
+		break;
+
+	case json::value_t::array:
+		for (auto &item : value)
+			seed = combine(seed, json_hash(item));
+		break;
+
+	case json::value_t::object:
+		for (auto &member : value.items()) {
+			seed = combine(seed, std::hash<std::string>()(member.key()));
+			seed = combine(seed, json_hash(member.value()));
+		}
+		break;
+
+	case json::value_t::binary:
+		for (auto byte : value.get_binary())
+			seed = combine(seed, byte);
+		break;
+	}
+
+	return seed;
+}
+
+bool has_duplicate_items(const json &array)
+{
+	// comparing all pairs is cheaper than hashing for a few items
+	if (array.size() <= 8) {
+		for (auto it = array.begin(); it != array.end(); ++it)
+			for (auto other = it + 1; other != array.end(); ++other)
+				if (*it == *other)
+					return true;
+		return false;
+	}
+
+	std::unordered_set<const json *, json_hasher, json_pointee_equal> seen(array.size());
+	for (auto &item : array)
+		if (!seen.insert(&item).second)
+			return true;
+	return false;
+}
+
+} // namespace json_schema
+} // namespace nlohmann
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <cstddef>
+
+namespace nlohmann
+{
+namespace json_schema
+{
+
+// Hash of the structure and values of a json, consistent with operator==:
+// numbers are hashed by their floating point value so that 1 and 1.0 are
+// equal, objects and arrays by their members in order.
+std::size_t json_hash(const json &value);
+
+struct json_hasher {
+	std::size_t operator()(const json &value) const { return json_hash(value); }
+	std::size_t operator()(const json *value) const { return json_hash(*value); }
+};
+
+struct json_pointee_equal {
+	bool operator()(const json *a, const json *b) const { return *a == *b; }
+};
+
+// whether an array contains two equal items
+bool has_duplicate_items(const json &array);
+
+} // namespace json_schema
+} // namespace nlohmann
@@ -8,17 +8,32 @@
  */
 #include <nlohmann/json-schema.hpp>
 
+#include "arena.hpp"
+#include "format-cache.hpp"
+#include "json-hash.hpp"
 #include "json-patch.hpp"
-
+#include "key-cache.hpp"
+#include "linear-regex.hpp"
+#include "utf8-length.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <deque>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 
 using nlohmann::json;
 using nlohmann::json_patch;
 using nlohmann::json_uri;
+using nlohmann::json_schema::arena;
+using nlohmann::json_schema::arena_allocator;
 using nlohmann::json_schema::root_schema;
 using namespace nlohmann::json_schema;
 
@@ -35,15 +50,163 @@ using namespace nlohmann::json_schema;
 namespace
 {
 
+class program_builder;
+
+#ifndef NO_STD_REGEX
+// process-wide table of compiled patterns by their text, identical patterns of
+// all schemas share one as long as any of them is alive
+template <typename T>
+class intern_table
+{
+	std::mutex mutex_;
+	std::unordered_map<std::string, std::weak_ptr<const T>> entries_;
+	std::size_t prune_at_ = 64;
+
+public:
+	template <typename Source>
+	std::shared_ptr<const T> get(const std::string &key, const Source &source)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		auto &entry = entries_[key];
+		auto shared = entry.lock();
+		if (!shared) {
+			shared = std::make_shared<const T>(source);
+			entry = shared;
+		}
+
+		// forget the patterns of destroyed schemas
+		if (entries_.size() >= prune_at_) {
+			for (auto i = entries_.begin(); i != entries_.end();)
+				if (i->second.expired())
+					i = entries_.erase(i);
+				else
+					++i;
+			prune_at_ = std::max<std::size_t>(64, 2 * entries_.size());
+		}
+		return shared;
+	}
+};
+
+// pattern of a schema, matched by the linear_regex unless it uses constructs
+// only supported by REGEX_NAMESPACE - which matches wide strings, so that both
+// match code points: ., {n} or [^x] do not depend on the engine
+class schema_regex
+{
+	std::unique_ptr<linear_regex> linear_;
+	std::unique_ptr<REGEX_NAMESPACE::wregex> fallback_;
+
+	// where wchar_t has 16 bits those beyond the BMP are surrogate pairs, and
+	// invalid bytes are replacement characters
+	static std::wstring wide(const std::string &s)
+	{
+		std::wstring w;
+		for (auto c : utf8_code_points(s))
+			if (sizeof(wchar_t) >= 4)
+				w.push_back(static_cast<wchar_t>(c));
+			else if (c > 0x10ffff)
+				w.push_back(static_cast<wchar_t>(0xfffd));
+			else if (c > 0xffff) {
+				w.push_back(static_cast<wchar_t>(0xd800 + ((c - 0x10000) >> 10)));
+				w.push_back(static_cast<wchar_t>(0xdc00 + ((c - 0x10000) & 0x3ff)));
+			} else
+				w.push_back(static_cast<wchar_t>(c));
+		return w;
+	}
+
+public:
+	explicit schema_regex(const std::string &pattern)
+	{
+		try {
+			linear_.reset(new linear_regex(pattern));
+		} catch (const regex_unsupported &) {
+			fallback_.reset(new REGEX_NAMESPACE::wregex(wide(pattern), REGEX_NAMESPACE::wregex::ECMAScript));
+		}
+	}
+
+	static std::shared_ptr<const schema_regex> intern(const std::string &pattern)
+	{
+		static intern_table<schema_regex> table;
+		return table.get(pattern, pattern);
+	}
+
+	bool search(const std::string &subject) const
+	{
+		return linear_ ? linear_->search(subject) : REGEX_NAMESPACE::regex_search(wide(subject), *fallback_);
+	}
+};
+
+// patterns of patternProperties, those supported by linear_regex are matched
+// all at once
+class schema_regex_set
+{
+	std::unique_ptr<linear_regex> linear_;
+	std::vector<std::size_t> linear_patterns_; // index of each pattern in linear_
+	std::vector<std::pair<std::size_t, std::shared_ptr<const schema_regex>>> fallback_;
+
+public:
+	explicit schema_regex_set(const std::vector<std::string> &patterns)
+	{
+		std::vector<std::string> supported;
+		for (std::size_t i = 0; i < patterns.size(); i++)
+			try {
+				linear_regex check(patterns[i]);
+				supported.push_back(patterns[i]);
+				linear_patterns_.push_back(i);
+			} catch (const regex_unsupported &) {
+				fallback_.emplace_back(i, schema_regex::intern(patterns[i]));
+			}
+
+		if (!supported.empty())
+			linear_.reset(new linear_regex(supported));
+	}
+
+	static std::shared_ptr<const schema_regex_set> intern(const std::vector<std::string> &patterns)
+	{
+		static intern_table<schema_regex_set> table;
+		std::string key;
+		for (auto &pattern : patterns)
+			key += std::to_string(pattern.size()) + ':' + pattern;
+		return table.get(key, patterns);
+	}
+
+	// indices of the patterns matching subject, ascending
+	void search(const std::string &subject, std::vector<std::size_t> &matches) const
+	{
+		matches.clear();
+		if (linear_) {
+			linear_->search_all(subject, matches);
+			for (auto &m : matches)
+				m = linear_patterns_[m];
+		}
+
+		if (fallback_.empty())
+			return;
+		for (auto &f : fallback_)
+			if (f.second->search(subject))
+				matches.push_back(f.first);
+		std::sort(matches.begin(), matches.end());
+	}
+};
+#endif
+
+// containers of schemas, allocated from the arena of the root_schema
+template <typename T>
+using arena_vector = std::vector<T, arena_allocator<T>>;
+
+template <typename T>
+using arena_map = std::map<std::string, T, std::less<std::string>, arena_allocator<std::pair<const std::string, T>>>;
+
 class schema
 {
 protected:
 	root_schema *root_;
 	json default_value_ = nullptr;
+	std::string location_;
 
 protected:
-	virtual std::shared_ptr<schema> make_for_default_(
-	    std::shared_ptr<::schema> & /* sch */,
+	virtual schema *make_for_default_(
+	    schema * /* sch */,
 	    root_schema * /* root */,
 	    std::vector<nlohmann::json_uri> & /* uris */,
 	    nlohmann::json & /* default_value */) const
@@ -54,84 +217,834 @@ protected:
 public:
 	virtual ~schema() = default;
 
-	schema(root_schema *root)
-	    : root_(root) {}
+	schema(root_schema *root)
+	    : root_(root) {}
+
+	virtual void validate(const instance_path &ptr, const json &instance, json_patch &patch, error_handler &e) const = 0;
+
+	virtual const json &default_value(const instance_path &, const json &, error_handler &) const
+	{
+		return default_value_;
+	}
+
+	void set_default_value(const json &v) { default_value_ = v; }
+
+	// URI of the schema-object this schema has been created from, reported in error_records
+	const std::string &location() const { return location_; }
+	void set_location(const std::vector<nlohmann::json_uri> &uris)
+	{
+		if (!uris.empty())
+			location_ = uris.front().location() + "#" + uris.front().fragment();
+	}
+
+	// emit the instructions of this schema into the block currently built by the program_builder
+	virtual void compile(program_builder &) const = 0;
+
+	// the schema whose block is executed for this one - references are aliases of their target
+	virtual const schema *compiled_target() const { return this; }
+
+	// called once all schemas of the root_schema have been created and references are resolved
+	virtual void link() {}
+
+	// schemas are owned by the root_schema, they live until the next set_root_schema()
+	static schema *make(json &schema,
+	                    root_schema *root,
+	                    const std::vector<std::string> &key,
+	                    std::vector<nlohmann::json_uri> uris);
+};
+
+class schema_ref : public schema
+{
+	const std::string id_;
+	const schema *target_ = nullptr;
+	const schema *linked_ = nullptr; // set by link()
+
+	void validate(const instance_path &ptr, const json &instance, json_patch &patch, error_handler &e) const final
+	{
+		auto target = linked_ ? linked_ : target_;
+
+		if (target)
+			target->validate(ptr, instance, patch, e);
+		else
+			e.error(error_record(error_code::unresolved_reference, ptr, instance, location_, nullptr, &id_));
+	}
+
+	const json &default_value(const instance_path &ptr, const json &instance, error_handler &e) const override final
+	{
+		if (!default_value_.is_null())
+			return default_value_;
+
+		auto target = linked_ ? linked_ : target_;
+		if (target)
+			return target->default_value(ptr, instance, e);
+
+		e.error(error_record(error_code::unresolved_reference, ptr, instance, location_, nullptr, &id_));
+
+		return default_value_;
+	}
+
+protected:
+	schema *make_for_default_(
+	    schema *sch,
+	    root_schema *root,
+	    std::vector<nlohmann::json_uri> &uris,
+	    nlohmann::json &default_value) const override;
+
+public:
+	schema_ref(const std::string &id, root_schema *root)
+	    : schema(root), id_(id) {}
+
+	const std::string &id() const { return id_; }
+
+	void compile(program_builder &) const final;
+	const schema *compiled_target() const final { return linked_ ? linked_ : target_; }
+
+	// the target at the end of a chain of references, saves the hops during validation
+	void link() final
+	{
+		const schema *target = target_;
+		std::set<const schema *> seen{this};
+		while (target && target->compiled_target() != target) {
+			if (!seen.insert(target).second) { // a cycle of references, keep the direct target
+				target = target_;
+				break;
+			}
+			target = target->compiled_target();
+		}
+		linked_ = target;
+	}
+
+	void set_target(const schema *target) { target_ = target; }
+};
+
+template <typename T>
+struct numeric_keywords
+{
+	std::pair<bool, T> maximum_{false, 0};
+	std::pair<bool, T> minimum_{false, 0};
+
+	bool exclusiveMaximum_ = false;
+	bool exclusiveMinimum_ = false;
+
+	std::pair<bool, json::number_float_t> multipleOf_{false, 0};
+
+	// the limits as reported in error_records
+	json maximum_limit_, minimum_limit_, multipleOf_limit_;
+
+	void set_limits()
+	{
+		maximum_limit_ = maximum_.second;
+		minimum_limit_ = minimum_.second;
+		multipleOf_limit_ = multipleOf_.second;
+	}
+
+	// multipleOf - if the remainder of the division is 0 -> OK
+	bool violates_multiple_of(T x) const
+	{
+		double res = std::remainder(x, multipleOf_.second);
+		double multiple = std::fabs(x / multipleOf_.second);
+		if (multiple > 1) {
+			res = res / multiple;
+		}
+		double eps = std::nextafter(x, 0) - static_cast<double>(x);
+
+		return std::fabs(res) > std::fabs(eps);
+	}
+
+	bool is_valid(const json &instance) const
+	{
+		T value = instance;
+
+		if (multipleOf_.first && value != 0 && violates_multiple_of(value))
+			return false;
+
+		if (maximum_.first && (exclusiveMaximum_ ? value >= maximum_.second : value > maximum_.second))
+			return false;
+
+		if (minimum_.first && (exclusiveMinimum_ ? value <= minimum_.second : value < minimum_.second))
+			return false;
+
+		return true;
+	}
+
+	void validate(const instance_path &ptr, const json &instance, const std::string &location, error_handler &e) const
+	{
+		T value = instance; // conversion of json to value_type
+
+		if (multipleOf_.first && value != 0) // zero is multiple of everything
+			if (violates_multiple_of(value))
+				e.error(error_record(error_code::multiple_of, ptr, instance, location, &multipleOf_limit_));
+
+		if (maximum_.first) {
+			if (exclusiveMaximum_ && value >= maximum_.second)
+				e.error(error_record(error_code::exclusive_maximum, ptr, instance, location, &maximum_limit_));
+			else if (value > maximum_.second)
+				e.error(error_record(error_code::maximum, ptr, instance, location, &maximum_limit_));
+		}
+
+		if (minimum_.first) {
+			if (exclusiveMinimum_ && value <= minimum_.second)
+				e.error(error_record(error_code::exclusive_minimum, ptr, instance, location, &minimum_limit_));
+			else if (value < minimum_.second)
+				e.error(error_record(error_code::minimum, ptr, instance, location, &minimum_limit_));
+		}
+	}
+};
+
+// whether objects iterate their members sorted by name, required for merging
+// them with sorted tables - not the case for ordered_json-like object types
+template <typename T>
+struct is_sorted_object : std::false_type {
+};
+
+template <typename... Args>
+struct is_sorted_object<std::map<Args...>> : std::true_type {
+};
+
+// set of key-indices, allocates only for more than 64 keys
+class key_set
+{
+	std::uint64_t small_ = 0;
+	std::vector<bool> large_;
+
+public:
+	key_set(std::size_t size)
+	{
+		if (size > 64)
+			large_.resize(size);
+	}
+
+	void insert(std::size_t i)
+	{
+		if (large_.empty())
+			small_ |= std::uint64_t(1) << i;
+		else
+			large_[i] = true;
+	}
+
+	bool contains(std::size_t i) const
+	{
+		return large_.empty() ? (small_ >> i) & 1 : large_[i];
+	}
+};
+
+// bit of a json-type in a mask, numbers share one as they compare by value
+std::uint32_t type_bit(json::value_t type)
+{
+	switch (type) {
+	case json::value_t::number_integer:
+	case json::value_t::number_unsigned:
+		type = json::value_t::number_float;
+		break;
+	default:
+		break;
+	}
+	return std::uint32_t(1) << static_cast<unsigned>(type);
+}
+
+// operand value of instructions referring to an absent subschema
+const std::uint32_t no_block = std::numeric_limits<std::uint32_t>::max();
+
+enum class opcode : std::uint8_t {
+	unresolved_reference, // strings_
+	false_schema,
+	type_dispatch, // types_
+	enum_check,    // enums_
+	const_check,   // constants_
+	not_check,     // block
+	all_of,        // combinations_
+	any_of,        // combinations_
+	one_of,        // combinations_
+	if_then_else,  // conditionals_
+	null_default,  // constants_
+	expect_null,
+	numeric_integer, // integers_
+	numeric_float,   // floats_
+	string_length,   // lengths_
+	content,         // contents_
+	binary_rejected,
+	pattern,             // patterns_
+	format,              // formats_
+	max_properties,      // sizes_
+	min_properties,      // sizes_
+	object_members,      // objects_
+	dependency_required, // ranges_ of strings_
+	max_items,           // sizes_
+	min_items,           // sizes_
+	unique_items,
+	items,       // block
+	tuple_items, // tuples_
+	contains,    // block
+};
+
+struct instruction
+{
+	opcode op;
+	std::uint32_t operand;
+};
+
+/**
+ * Flat form of all schemas of a root_schema, built by the program_builder once
+ * set_root_schema() has finished.
+ *
+ * Each schema is lowered into a block - a contiguous range of instructions in
+ * code_. An instruction is an opcode with a single operand, which is either a
+ * block number or an index into one of the side tables. validate() interprets
+ * a block in a switch-loop, recursing only into subschema blocks.
+ *
+ * The schema classes themselves remain the reference implementation, they are
+ * used for validating when JSON_SCHEMA_REFERENCE_VALIDATOR is defined.
+ */
+class program
+{
+	friend class program_builder;
+
+public:
+	struct range {
+		std::uint32_t begin, end;
+	};
+
+	// a name of properties, dependencies or required of an object-schema
+	struct object_key {
+		std::string name;
+		std::uint32_t property;      // block or no_block
+		std::uint32_t default_value; // index in constants_ or no_block
+		std::uint32_t dependency;    // block or no_block
+		// a schema whose default_value() reports errors - like an unresolved
+		// reference - asked each time the property is absent, else null
+		const schema *reported_default;
+	};
+
+	// the blocks validating a member of an object by its name - its property
+	// and matching patternProperties or else additionalProperties
+	struct member_blocks {
+		std::vector<std::uint32_t> blocks;
+		bool additional; // blocks holds additionalProperties only
+	};
+
+	// names longer than this are not cached, they rarely repeat
+	static const std::size_t max_cached_key_length = 256;
+
+	struct object_layout {
+		range keys;               // object_keys_, sorted by name
+		range required;           // key_lists_, in schema order
+		range pattern_properties; // block_lists_, per pattern
+#ifndef NO_STD_REGEX
+		const schema_regex_set *patterns;
+#endif
+		std::uint32_t additional_properties;
+		std::uint32_t property_names;
+		bool lookups; // keys are looked up in the instance for required, defaults or dependencies
+		bool members; // each member of the instance is validated
+		key_cache<member_blocks> *cached_keys; // of recently seen names, null if not cached
+	};
+
+	struct tuple_layout {
+		range items; // block_lists_
+		std::uint32_t additional_items;
+	};
+
+	struct conditional {
+		std::uint32_t if_, then_, else_;
+	};
+
+	struct combination {
+		range cases; // block_lists_
+		json count;
+		std::uint32_t dispatch; // dispatches_ or no_block
+	};
+
+	// the cases of an anyOf or oneOf which can succeed for an instance, in
+	// order - all others are known to fail
+	struct dispatch {
+		std::array<range, static_cast<std::size_t>(json::value_t::discarded) + 1> types; // block_lists_, per json::value_t
+		// for objects, by the value of a property constrained by the cases
+		std::string property;
+		std::unordered_map<std::string, range> values;
+		range other_value, absent;
+	};
+
+	// a format keyword with the check bound to it
+	struct format {
+		const format_value_checker *check;
+		const json *name;
+	};
+
+	// minLength and maxLength, a source is null if the keyword is absent
+	struct length_bounds {
+		std::size_t min, max;
+		const json *min_source, *max_source;
+	};
+
+	struct content {
+		std::string encoding, media_type;
+		json keywords; // [encoding, media_type]
+	};
+
+	struct enumeration {
+		std::uint32_t values; // constants_
+		std::uint32_t types;  // type_bit() of all values
+		// json_hash() of the values with their index, sorted - empty if the
+		// values are few and compared one after the other
+		std::vector<std::pair<std::size_t, std::uint32_t>> hashes;
+	};
+
+#ifndef NO_STD_REGEX
+	struct pattern {
+		const schema_regex *regex;
+		const json *source;
+	};
+#endif
+
+	// block per json::value_t
+	typedef std::array<std::uint32_t, static_cast<std::size_t>(json::value_t::discarded) + 1> type_table;
+
+private:
+	root_schema *root_;
+	std::size_t cached_keys_; // per object, 0 if member_blocks are not cached
+
+	std::vector<instruction> code_;
+	std::vector<range> blocks_;
+	std::vector<const std::string *> locations_; // per block
+	std::unordered_map<const schema *, std::uint32_t> entries_;
+
+	std::vector<type_table> types_;
+	std::vector<json> constants_;
+	std::vector<std::pair<std::size_t, json>> sizes_; // the json is the limit reported in error_records
+	std::vector<std::string> strings_;
+	std::vector<range> ranges_;
+	std::vector<std::uint32_t> block_lists_;
+	std::vector<object_key> object_keys_;
+	std::vector<std::uint32_t> key_lists_; // offsets into a range of object_keys_
+	std::vector<object_layout> objects_;
+	std::vector<std::unique_ptr<key_cache<member_blocks>>> key_caches_; // of objects_
+	std::vector<tuple_layout> tuples_;
+	std::vector<conditional> conditionals_;
+	std::vector<combination> combinations_;
+	std::vector<dispatch> dispatches_;
+	std::vector<length_bounds> lengths_;
+	std::vector<format> formats_;
+	std::vector<content> contents_;
+	std::vector<enumeration> enums_;
+	std::vector<numeric_keywords<json::number_integer_t>> integers_;
+	std::vector<numeric_keywords<json::number_float_t>> floats_;
+#ifndef NO_STD_REGEX
+	std::vector<pattern> patterns_;
+#endif
+
+	const object_key *find_key(const range &r, const std::string &name) const;
+	const range &candidates(const dispatch &d, const json &instance) const;
+
+	// validates the n items of an array or members of an object on the pool
+	// in chunks, each collecting its errors and default values, which are
+	// handed on in order once all chunks are done
+	template <typename Validate>
+	bool in_parallel(thread_pool &pool, std::size_t n, json_patch *patch, error_handler *e, const Validate &validate) const;
+
+	// without an error_handler validation stops at the first error (fail-fast) and
+	// returns false, without a patch no default values are collected
+	bool run(std::uint32_t block, const instance_path &ptr, const json &instance, json_patch *patch, error_handler *e) const;
+
+public:
+	program(root_schema *root, std::size_t cached_keys = 0)
+	    : root_(root), cached_keys_(cached_keys) {}
+
+	// block of a schema, no_block if it has not been compiled
+	std::uint32_t entry(const schema *s) const
+	{
+		auto block = entries_.find(s);
+		return block == entries_.end() ? no_block : block->second;
+	}
+
+	void validate(std::uint32_t block, const instance_path &ptr, const json &instance, json_patch &patch, error_handler &e) const
+	{
+		run(block, ptr, instance, &patch, &e);
+	}
+
+	bool is_valid(std::uint32_t block, const json &instance) const
+	{
+		return run(block, instance_path(), instance, nullptr, nullptr);
+	}
+};
+
+/**
+ * Lowers schemas into a program. Schemas are assigned a block number when
+ * first seen through block() and their instructions are emitted later by
+ * build() - one schema at a time, so that each block stays contiguous.
+ */
+class program_builder
+{
+	program &p_;
+	std::deque<std::pair<const schema *, std::uint32_t>> pending_;
+
+	template <typename T>
+	static std::uint32_t append(std::vector<T> &table, T value)
+	{
+		table.push_back(std::move(value));
+		return static_cast<std::uint32_t>(table.size() - 1);
+	}
+
+	// what an instance has to be for a block to succeed, as far as it is known
+	struct property_facts {
+		bool required = false;
+		bool any_value = true;
+		std::vector<json> values; // unless any_value, the property is one of them
+	};
+
+	struct facts {
+		std::uint32_t types = ~std::uint32_t(0); // bits of json::value_t
+		bool any_value = true;
+		std::vector<json> values;
+		std::map<std::string, property_facts> properties; // of objects
+	};
+
+	static void intersect(bool &any_value, std::vector<json> &values, const json &allowed)
+	{
+		if (any_value) {
+			values.assign(allowed.begin(), allowed.end());
+			any_value = false;
+		} else
+			values.erase(std::remove_if(values.begin(), values.end(),
+			                            [&](const json &v) { return std::find(allowed.begin(), allowed.end(), v) == allowed.end(); }),
+			             values.end());
+	}
+
+	// the keywords of a block are all required to succeed, combinations other
+	// than allOf and references deeper than depth are not looked into
+	void gather(std::uint32_t block, facts &f, int depth) const
+	{
+		if (block == no_block || depth == 0)
+			return;
+
+		const auto &b = p_.blocks_[block];
+		for (auto pc = b.begin; pc != b.end; ++pc) {
+			const auto operand = p_.code_[pc].operand;
+
+			switch (p_.code_[pc].op) {
+			case opcode::false_schema:
+				f.types = 0;
+				break;
+
+			case opcode::type_dispatch: {
+				const auto &table = p_.types_[operand];
+				std::uint32_t types = 0;
+				for (std::size_t t = 0; t < table.size(); ++t)
+					if (table[t] != no_block)
+						types |= std::uint32_t(1) << t;
+				f.types &= types;
+				gather(table[static_cast<std::size_t>(json::value_t::object)], f, depth - 1);
+			} break;
+
+			case opcode::enum_check: {
+				const auto &values = p_.constants_[p_.enums_[operand].values];
+				if (values.is_array())
+					intersect(f.any_value, f.values, values);
+			} break;
+
+			case opcode::const_check:
+				intersect(f.any_value, f.values, json::array({p_.constants_[operand]}));
+				break;
+
+			case opcode::all_of: {
+				const auto &cases = p_.combinations_[operand].cases;
+				for (auto c = cases.begin; c != cases.end; ++c)
+					gather(p_.block_lists_[c], f, depth - 1);
+			} break;
+
+			case opcode::object_members: {
+				const auto &o = p_.objects_[operand];
+				for (auto r = o.required.begin; r != o.required.end; ++r)
+					f.properties[p_.object_keys_[o.keys.begin + p_.key_lists_[r]].name].required = true;
+
+				for (auto k = o.keys.begin; k != o.keys.end; ++k) {
+					facts property;
+					gather(p_.object_keys_[k].property, property, depth - 1);
+					if (!property.any_value) {
+						auto &known = f.properties[p_.object_keys_[k].name];
+						intersect(known.any_value, known.values, property.values);
+					}
+				}
+			} break;
+
+			default:
+				break;
+			}
+		}
+
+		// a const or enum also limits the types, numbers compare by value
+		if (!f.any_value) {
+			auto bit = [](json::value_t type) { return std::uint32_t(1) << static_cast<unsigned>(type); };
+			std::uint32_t types = 0;
+			for (auto &v : f.values)
+				types |= v.is_number() ? bit(json::value_t::number_integer) | bit(json::value_t::number_unsigned) | bit(json::value_t::number_float)
+				                       : bit(v.type());
+			f.types &= types;
+		}
+	}
+
+	static bool only_strings(const property_facts &p)
+	{
+		return !p.any_value && std::all_of(p.values.begin(), p.values.end(), [](const json &v) { return v.is_string(); });
+	}
+
+	template <typename Predicate>
+	program::range candidates(const std::vector<std::uint32_t> &blocks, const Predicate &can_succeed)
+	{
+		program::range r{static_cast<std::uint32_t>(p_.block_lists_.size()), 0};
+		for (std::size_t c = 0; c < blocks.size(); ++c)
+			if (can_succeed(c))
+				p_.block_lists_.push_back(blocks[c]);
+		r.end = static_cast<std::uint32_t>(p_.block_lists_.size());
+		return r;
+	}
+
+	// anyOf and oneOf only run the cases which can succeed for an instance:
+	// selected by its type and, for objects, by the value of a discriminating
+	// property - the one with a const or enum of strings in the most cases
+	void dispatch(program::combination &c)
+	{
+		const std::vector<std::uint32_t> blocks(p_.block_lists_.begin() + c.cases.begin, p_.block_lists_.begin() + c.cases.end);
+		std::vector<facts> cases(blocks.size());
+		for (std::size_t i = 0; i < blocks.size(); ++i)
+			gather(blocks[i], cases[i], 8);
+
+		const auto object = std::uint32_t(1) << static_cast<unsigned>(json::value_t::object);
+		std::map<std::string, std::size_t> constrained;
+		for (auto &f : cases)
+			if (f.types & object)
+				for (auto &p : f.properties)
+					if (only_strings(p.second))
+						constrained[p.first]++;
+
+		program::dispatch d;
+		std::size_t most = 1;
+		for (auto &p : constrained)
+			if (p.second > most) {
+				d.property = p.first;
+				most = p.second;
+			}
+
+		const auto unused = p_.block_lists_.size();
+		bool narrowed = false;
+		auto add = [&](const auto &can_succeed) {
+			auto r = candidates(blocks, can_succeed);
+			narrowed |= r.end - r.begin < blocks.size();
+			return r;
+		};
+
+		for (std::size_t t = 0; t < d.types.size(); ++t)
+			d.types[t] = add([&](std::size_t i) { return (cases[i].types >> t) & 1; });
+
+		if (!d.property.empty()) {
+			auto property = [&](std::size_t i) -> const property_facts * {
+				auto p = cases[i].properties.find(d.property);
+				return p == cases[i].properties.end() ? nullptr : &p->second;
+			};
+			auto any_string = [&](std::size_t i) {
+				auto p = property(i);
+				return (cases[i].types & object) && (!p || !only_strings(*p));
+			};
+
+			std::set<std::string> values;
+			for (std::size_t i = 0; i < cases.size(); ++i)
+				if (property(i) && only_strings(*property(i)))
+					for (auto &v : property(i)->values)
+						values.insert(v.get<std::string>());
+
+			for (auto &value : values)
+				d.values[value] = add([&](std::size_t i) {
+					auto p = property(i);
+					return any_string(i) || ((cases[i].types & object) && std::find(p->values.begin(), p->values.end(), value) != p->values.end());
+				});
+			d.other_value = add(any_string);
+			d.absent = add([&](std::size_t i) {
+				auto p = property(i);
+				return (cases[i].types & object) && (!p || !p->required);
+			});
+		}
+
+		if (narrowed)
+			c.dispatch = append(p_.dispatches_, std::move(d));
+		else
+			p_.block_lists_.resize(unused);
+	}
+
+public:
+	program_builder(program &p)
+	    : p_(p) {}
+
+	std::uint32_t block(const schema *s)
+	{
+		if (!s)
+			return no_block;
+
+		// follow chains of references to the schema doing the actual work,
+		// a reference which cannot be followed is compiled on its own
+		const schema *target = s;
+		std::set<const schema *> seen;
+		for (auto next = s->compiled_target(); next && next != target; next = target->compiled_target()) {
+			if (!seen.insert(target).second) {
+				target = s;
+				break;
+			}
+			target = next;
+		}
+
+		auto known = p_.entries_.find(target);
+		if (known != p_.entries_.end()) {
+			p_.entries_.emplace(s, known->second);
+			return known->second;
+		}
 
-	virtual void validate(const json::json_pointer &ptr, const json &instance, json_patch &patch, error_handler &e) const = 0;
+		auto id = append(p_.blocks_, program::range{0, 0});
+		p_.locations_.push_back(&target->location());
+		p_.entries_.emplace(target, id);
+		p_.entries_.emplace(s, id);
+		pending_.emplace_back(target, id);
+		return id;
+	}
 
-	virtual const json &default_value(const json::json_pointer &, const json &, error_handler &) const
+	void build()
 	{
-		return default_value_;
+		while (!pending_.empty()) {
+			auto next = pending_.front();
+			pending_.pop_front();
+
+			p_.blocks_[next.second].begin = static_cast<std::uint32_t>(p_.code_.size());
+			next.first->compile(*this);
+			p_.blocks_[next.second].end = static_cast<std::uint32_t>(p_.code_.size());
+		}
+
+		for (auto &i : p_.code_)
+			if (i.op == opcode::any_of || i.op == opcode::one_of)
+				dispatch(p_.combinations_[i.operand]);
 	}
 
-	void set_default_value(const json &v) { default_value_ = v; }
+	void emit(opcode op, std::uint32_t operand = 0) { p_.code_.push_back({op, operand}); }
 
-	static std::shared_ptr<schema> make(json &schema,
-	                                    root_schema *root,
-	                                    const std::vector<std::string> &key,
-	                                    std::vector<nlohmann::json_uri> uris);
-};
+	std::uint32_t constant(const json &value) { return append(p_.constants_, value); }
+	std::uint32_t size(const json &limit) { return append(p_.sizes_, {limit.get<std::size_t>(), limit}); }
+	std::uint32_t string(const std::string &value) { return append(p_.strings_, value); }
 
-class schema_ref : public schema
-{
-	const std::string id_;
-	std::weak_ptr<schema> target_;
-	std::shared_ptr<schema> target_strong_; // for references to references keep also the shared_ptr because
-	                                        // no one else might use it after resolving
+	template <typename Strings>
+	std::uint32_t strings(const Strings &values)
+	{
+		program::range r{static_cast<std::uint32_t>(p_.strings_.size()), 0};
+		p_.strings_.insert(p_.strings_.end(), values.begin(), values.end());
+		r.end = static_cast<std::uint32_t>(p_.strings_.size());
+		return append(p_.ranges_, r);
+	}
 
-	void validate(const json::json_pointer &ptr, const json &instance, json_patch &patch, error_handler &e) const final
+	template <typename Schemas>
+	program::range blocks(const Schemas &subschemata)
 	{
-		auto target = target_.lock();
+		// reserve all blocks first, block() must not be interleaved with the list
+		std::vector<std::uint32_t> ids;
+		for (auto s : subschemata)
+			ids.push_back(block(s));
+
+		program::range r{static_cast<std::uint32_t>(p_.block_lists_.size()), 0};
+		p_.block_lists_.insert(p_.block_lists_.end(), ids.begin(), ids.end());
+		r.end = static_cast<std::uint32_t>(p_.block_lists_.size());
+		return r;
+	}
 
-		if (target)
-			target->validate(ptr, instance, patch, e);
-		else
-			e.error(ptr, instance, "unresolved or freed schema-reference " + id_);
+	template <typename Schemas>
+	std::uint32_t combination(const Schemas &subschemata)
+	{
+		auto cases = blocks(subschemata);
+		return append(p_.combinations_, {cases, json(subschemata.size()), no_block});
 	}
 
-	const json &default_value(const json::json_pointer &ptr, const json &instance, error_handler &e) const override final
+	// the names of properties, dependencies and required merged into one table
+	// sorted by name, default_values are resolved now as they are static once
+	// all references are resolved
+	template <typename Properties, typename Required>
+	void object_keys(const Properties &props, const Properties &deps, const Required &required,
+	                 program::object_layout &layout)
 	{
-		if (!default_value_.is_null())
-			return default_value_;
+		std::map<std::string, program::object_key> keys;
+		auto key = [&keys](const std::string &name) -> program::object_key & {
+			return keys.insert({name, {name, no_block, no_block, no_block, nullptr}}).first->second;
+		};
 
-		auto target = target_.lock();
-		if (target)
-			return target->default_value(ptr, instance, e);
+		for (auto &prop : props) {
+			auto &k = key(prop.first);
+			k.property = block(prop.second);
+			basic_error_handler reported;
+			const auto &value = prop.second->default_value(instance_path(), json(), reported);
+			if (reported) {
+				k.reported_default = prop.second;
+				layout.lookups = true;
+			} else if (!value.is_null()) {
+				k.default_value = constant(value);
+				layout.lookups = true;
+			}
+		}
+		for (auto &dep : deps) {
+			key(dep.first).dependency = block(dep.second);
+			layout.lookups = true;
+		}
+		for (auto &name : required) {
+			key(name);
+			layout.lookups = true;
+		}
 
-		e.error(ptr, instance, "unresolved or freed schema-reference " + id_);
+		layout.keys.begin = static_cast<std::uint32_t>(p_.object_keys_.size());
+		for (auto &k : keys)
+			p_.object_keys_.push_back(k.second);
+		layout.keys.end = static_cast<std::uint32_t>(p_.object_keys_.size());
 
-		return default_value_;
+		layout.required.begin = static_cast<std::uint32_t>(p_.key_lists_.size());
+		for (auto &name : required)
+			p_.key_lists_.push_back(static_cast<std::uint32_t>(std::distance(keys.begin(), keys.find(name))));
+		layout.required.end = static_cast<std::uint32_t>(p_.key_lists_.size());
 	}
 
-protected:
-	virtual std::shared_ptr<schema> make_for_default_(
-	    std::shared_ptr<::schema> &sch,
-	    root_schema *root,
-	    std::vector<nlohmann::json_uri> &uris,
-	    nlohmann::json &default_value) const override
-	{
-		// create a new reference schema using the original reference (which will be resolved later)
-		// to store this overloaded default value #209
-		auto result = std::make_shared<schema_ref>(uris[0].to_string(), root);
-		result->set_target(sch, true);
-		result->set_default_value(default_value);
-		return result;
-	};
-
-public:
-	schema_ref(const std::string &id, root_schema *root)
-	    : schema(root), id_(id) {}
+#ifndef NO_STD_REGEX
+	std::uint32_t add(const program::pattern &value) { return append(p_.patterns_, value); }
+#endif
 
-	const std::string &id() const { return id_; }
+	std::uint32_t add(const program::type_table &value) { return append(p_.types_, value); }
+	std::uint32_t add(program::object_layout value)
+	{
+		if (value.members && p_.cached_keys_) {
+			p_.key_caches_.emplace_back(new key_cache<program::member_blocks>(p_.cached_keys_));
+			value.cached_keys = p_.key_caches_.back().get();
+		}
+		return append(p_.objects_, value);
+	}
+	std::uint32_t add(const program::tuple_layout &value) { return append(p_.tuples_, value); }
+	std::uint32_t add(const program::conditional &value) { return append(p_.conditionals_, value); }
+	std::uint32_t add(const program::length_bounds &value) { return append(p_.lengths_, value); }
+	std::uint32_t add(const program::format &value) { return append(p_.formats_, value); }
+	std::uint32_t add(const program::content &value) { return append(p_.contents_, value); }
 
-	void set_target(const std::shared_ptr<schema> &target, bool strong = false)
+	std::uint32_t enumeration(const json &values)
 	{
-		target_ = target;
-		if (strong)
-			target_strong_ = target;
+		program::enumeration index{constant(values), 0, {}};
+		if (!values.is_array()) // iterated as a single value
+			index.types = ~std::uint32_t(0);
+		for (auto &v : values)
+			index.types |= type_bit(v.type());
+
+		if (values.size() > 8) {
+			for (std::uint32_t i = 0; i < values.size(); i++)
+				index.hashes.emplace_back(json_hash(values[i]), i);
+			std::sort(index.hashes.begin(), index.hashes.end());
+		}
+		return append(p_.enums_, std::move(index));
 	}
+	std::uint32_t add(const numeric_keywords<json::number_integer_t> &value) { return append(p_.integers_, value); }
+	std::uint32_t add(const numeric_keywords<json::number_float_t> &value) { return append(p_.floats_, value); }
 };
 
+void schema_ref::compile(program_builder &b) const
+{
+	// only reached if the reference cannot be followed
+	b.emit(opcode::unresolved_reference, b.string(id_));
+}
+
 } // namespace
 
 namespace nlohmann
@@ -141,15 +1054,36 @@ namespace json_schema
 
 class root_schema
 {
+	// owns all schemas and their containers, declared first to be destroyed last
+	arena arena_;
+
 	schema_loader loader_;
 	format_checker format_check_;
 	content_checker content_check_;
+	std::map<std::string, format_value_checker> formats_; // added one by one
+
+	// ids of the formats whose outcomes are cached, in a cache of all of them
+	std::map<std::string, std::size_t> cached_formats_;
+	std::size_t format_cache_size_ = 8192;
+	std::shared_ptr<format_cache> format_cache_;
+
+	// names of members remembered per object, 0 for none
+	std::size_t object_key_cache_size_ = 0;
+
+	// validating large arrays and objects in parallel
+	std::shared_ptr<thread_pool> pool_;
+	std::size_t parallel_threshold_ = 0;
+
+	// pool of the validator, created on first use - by set_parallel() or validate_batch()
+	mutable std::mutex own_pool_mutex_;
+	mutable std::shared_ptr<thread_pool> own_pool_;
 
-	std::shared_ptr<schema> root_;
+	schema *root_ = nullptr;
+	program program_;
 
 	struct schema_file {
-		std::map<std::string, std::shared_ptr<schema>> schemas;
-		std::map<std::string, std::shared_ptr<schema_ref>> unresolved; // contains all unresolved references from any other file seen during parsing
+		std::map<std::string, schema *> schemas;
+		std::map<std::string, schema_ref *> unresolved; // contains all unresolved references from any other file seen during parsing
 		json unknown_keywords;
 	};
 
@@ -172,14 +1106,114 @@ public:
 
 	    : loader_(std::move(loader)),
 	      format_check_(std::move(format)),
-	      content_check_(std::move(content))
+	      content_check_(std::move(content)),
+	      program_(this)
 	{
 	}
 
 	format_checker &format_check() { return format_check_; }
+
+	void add_format(const std::string &format, format_value_checker &&check) { formats_[format] = std::move(check); }
+
+	void cache_format(const std::string &format) { cached_formats_.emplace(format, cached_formats_.size()); }
+	void set_format_cache_size(std::size_t entries) { format_cache_size_ = entries; }
+	void cache_object_keys(std::size_t entries) { object_key_cache_size_ = entries; }
+
+	void set_parallel(std::size_t threshold, std::shared_ptr<thread_pool> pool)
+	{
+		if (threshold && !pool)
+			pool = pool_ ? pool_ : own_pool();
+		pool_ = threshold ? std::move(pool) : nullptr;
+		parallel_threshold_ = threshold;
+	}
+
+	// the pool if an array or object of size is validated in parallel, else null
+	thread_pool *parallel_pool(std::size_t size) const
+	{
+		return parallel_threshold_ && size >= parallel_threshold_ ? pool_.get() : nullptr;
+	}
+
+	// the pool of set_parallel(), null if none
+	thread_pool *pool() const { return pool_.get(); }
+
+	// the pool of the validator, kept for all later calls
+	std::shared_ptr<thread_pool> own_pool() const
+	{
+		std::lock_guard<std::mutex> lock(own_pool_mutex_);
+		if (!own_pool_)
+			own_pool_ = std::make_shared<thread_pool>();
+		return own_pool_;
+	}
+
+	format_cache_stats cache_stats(const std::string &format) const
+	{
+		auto cached = cached_formats_.find(format);
+		if (cached == cached_formats_.end() || !format_cache_)
+			return {};
+		auto &counters = format_cache_->of(cached->second);
+		return {counters.hits.load(std::memory_order_relaxed), counters.misses.load(std::memory_order_relaxed)};
+	}
+
+	// the check of a format, decided once when the schema is compiled: an added
+	// one, a built-in one of the default format_checker, or else the
+	// format_checker called with the name - null if there is none
+	format_value_checker bind_format(const std::string &format) const
+	{
+		auto check = uncached_format(format);
+		auto cached = cached_formats_.find(format);
+		if (check == nullptr || cached == cached_formats_.end())
+			return check;
+
+		// values repeat, the outcome of the check is remembered - a failure is
+		// checked again for its message when it is reported
+		auto cache = format_cache_;
+		auto id = cached->second;
+		return [cache, id, check](const std::string &value) -> check_status {
+			int code;
+			if (cache->find(id, value, code)) {
+				cache->of(id).hits.fetch_add(1, std::memory_order_relaxed);
+				if (code == check_status::success)
+					return {};
+				return {code, [&check, &value] { return check.check(value).message(); }};
+			}
+
+			cache->of(id).misses.fetch_add(1, std::memory_order_relaxed);
+			auto status = check.check(value);
+			cache->insert(id, value, status.code());
+			return status;
+		};
+	}
+
+	format_value_checker uncached_format(const std::string &format) const
+	{
+		auto added = formats_.find(format);
+		if (added != formats_.end())
+			return added->second;
+
+		if (format_check_ == nullptr)
+			return nullptr;
+
+		auto function = format_check_.target<void (*)(const std::string &, const std::string &)>();
+		if (function && *function == &default_string_format_check) {
+			auto builtin = default_string_format(format);
+			if (builtin != nullptr)
+				return builtin;
+		}
+
+		auto check = format_check_;
+		return [check, format](const std::string &value) { return check.check(format, value); };
+	}
 	content_checker &content_check() { return content_check_; }
 
-	void insert(const json_uri &uri, const std::shared_ptr<schema> &s)
+	arena &memory() { return arena_; }
+
+	template <typename T, typename... Args>
+	T *create(Args &&...args)
+	{
+		return arena_.make<T>(std::forward<Args>(args)...);
+	}
+
+	void insert(const json_uri &uri, schema *s)
 	{
 		auto &file = get_or_create_file(uri.location());
 		auto sch = file.schemas.lower_bound(uri.fragment());
@@ -241,7 +1275,7 @@ public:
 				insert_unknown_keyword(new_uri, subsch.key(), subsch.value());
 	}
 
-	std::shared_ptr<schema> get_or_create_ref(const json_uri &uri)
+	schema *get_or_create_ref(const json_uri &uri)
 	{
 		auto &file = get_or_create_file(uri.location());
 
@@ -271,15 +1305,23 @@ public:
 		if (r != file.unresolved.end() && !(file.unresolved.key_comp()(uri.fragment(), r->first))) {
 			return r->second; // unresolved, already seen previously - use existing reference
 		} else {
-			return file.unresolved.insert(r,
-			                              {uri.fragment(), std::make_shared<schema_ref>(uri.to_string(), this)})
-			    ->second; // unresolved, create reference
+			auto ref = create<schema_ref>(uri.to_string(), this);
+			ref->set_location({uri}); // the referenced URI, the reference is shared by all referring schemas
+			return file.unresolved.insert(r, {uri.fragment(), ref})->second; // unresolved, create reference
 		}
 	}
 
 	void set_root_schema(json sch)
 	{
+		program_ = program(this, object_key_cache_size_); // refers to the schemas about to be freed
 		files_.clear();
+		root_ = nullptr;
+		arena_.clear();
+
+		format_cache_.reset();
+		if (!cached_formats_.empty())
+			format_cache_ = std::make_shared<format_cache>(format_cache_size_, cached_formats_.size());
+
 		root_ = schema::make(sch, this, {}, {{"#"}});
 
 		// load all files which have not yet been loaded
@@ -310,6 +1352,20 @@ public:
 				break;
 		} while (1);
 
+		// resolve references to their final targets
+		for (auto &file : files_)
+			for (auto &entry : file.second.schemas)
+				entry.second->link();
+
+		// every schema can be an entry point for validate(), lower all of them -
+		// before reporting undefined references, those are compiled into
+		// unresolved_reference-instructions for whoever validates nonetheless
+		program_builder builder(program_);
+		for (auto &file : files_)
+			for (auto &entry : file.second.schemas)
+				builder.block(entry.second);
+		builder.build();
+
 		for (const auto &file : files_) {
 			if (file.second.unresolved.size() != 0) {
 				// Build a representation of the undefined
@@ -335,14 +1391,15 @@ public:
 				                            "' has still the following undefined references: " + urefs);
 			}
 		}
+
 	}
 
-	void validate(const json::json_pointer &ptr,
-	              const json &instance,
+	void validate(const json &instance,
 	              json_patch &patch,
 	              error_handler &e,
 	              const json_uri &initial) const
 	{
+		json::json_pointer ptr;
 		if (!root_) {
 			e.error(ptr, "", "no root schema has yet been set for validating an instance");
 			return;
@@ -361,7 +1418,37 @@ public:
 			return;
 		}
 
-		sch->second->validate(ptr, instance, patch, e);
+#ifdef JSON_SCHEMA_REFERENCE_VALIDATOR
+		sch->second->validate(instance_path(), instance, patch, e);
+#else
+		auto block = program_.entry(sch->second);
+		if (block == no_block) { // set_root_schema() failed before the program was built
+			e.error(ptr, "", "no program has been compiled for the requested root-URI: " + initial.to_string());
+			return;
+		}
+
+		program_.validate(block, instance_path(), instance, patch, e);
+#endif
+	}
+
+	// fail-fast validation against the root-schema, no error-messages and no default values are produced
+	bool validate(const json &instance) const
+	{
+		if (!root_)
+			return false;
+
+#ifdef JSON_SCHEMA_REFERENCE_VALIDATOR
+		basic_error_handler e;
+		json_patch patch;
+		root_->validate(instance_path(), instance, patch, e);
+		return !e;
+#else
+		auto block = program_.entry(root_);
+		if (block == no_block) // set_root_schema() failed before the program was built
+			return false;
+
+		return program_.is_valid(block, instance);
+#endif
 	}
 };
 
@@ -371,22 +1458,126 @@ public:
 namespace
 {
 
-class first_error_handler : public error_handler
+schema *schema_ref::make_for_default_(
+    schema *sch,
+    root_schema *root,
+    std::vector<nlohmann::json_uri> &uris,
+    nlohmann::json &default_value) const
+{
+	// create a new reference schema using the original reference (which will be resolved later)
+	// to store this overloaded default value #209
+	auto result = root->create<schema_ref>(uris[0].to_string(), root);
+	result->set_location(uris);
+	result->set_target(sch);
+	result->set_default_value(default_value);
+	return result;
+}
+
+// an error_record kept beyond the error_handler::error()-call, its message is still rendered only on demand -
+// like the path, the instance is referred to and has to outlive the stored error (see error_store)
+class stored_error
+{
+	error_code code_;
+	std::vector<instance_path> path_; // root first, the keys refer to the instance being validated
+	const json *instance_;
+	const std::string *schema_location_; // schema_locations and limits are owned by the schemas
+	const json *limit_;
+	std::pair<bool, std::string> detail_;
+	std::shared_ptr<const stored_error> cause_;
+	std::string prefix_;
+
+public:
+	stored_error(const error_record &r, const std::string &prefix = "")
+	    : code_(r.code()), instance_(&r.instance()),
+	      schema_location_(&r.schema_location()), limit_(r.limit()),
+	      detail_(r.detail() != nullptr, r.detail() ? *r.detail() : ""),
+	      cause_(r.cause() ? std::make_shared<stored_error>(*r.cause()) : nullptr),
+	      prefix_(r.prefix() ? prefix + *r.prefix() : prefix)
+	{
+		std::size_t depth = 1;
+		for (auto p = &r.path(); p->parent(); p = p->parent())
+			depth++;
+
+		// the copied nodes are re-linked to their copied parents
+		path_.resize(depth);
+		auto p = &r.path();
+		for (auto i = depth - 1; i > 0; --i, p = p->parent())
+			path_[i] = p->key() ? instance_path(path_[i - 1], *p->key()) : instance_path(path_[i - 1], p->index());
+	}
+
+	stored_error(const stored_error &) = delete; // path_ refers to itself
+	stored_error(stored_error &&) = default;
+
+	// calls f with the error_record of this error, prefix is prepended to the stored one
+	void visit(const std::string &prefix, const std::function<void(const error_record &)> &f) const
+	{
+		auto full_prefix = prefix + prefix_;
+		auto report = [&](const error_record *cause) {
+			f(error_record(code_, path_.back(), *instance_, *schema_location_, limit_,
+			               detail_.first ? &detail_.second : nullptr, cause,
+			               full_prefix.empty() ? nullptr : &full_prefix));
+		};
+
+		if (cause_)
+			cause_->visit("", [&](const error_record &cause) { report(&cause); });
+		else
+			report(nullptr);
+	}
+
+	void report(error_handler &e, const std::string &prefix = "") const
+	{
+		visit(prefix, [&](const error_record &r) { e.error(r); });
+	}
+};
+
+// base of the error_handlers storing errors: the instances of stored errors are
+// part of the validated instance, except for the names validated by
+// propertyNames - those are kept by the store
+class error_store : public error_handler
+{
+	std::vector<std::shared_ptr<const json>> names_;
+
+public:
+	// the name as instance for propertyNames, living as long as the errors e stores
+	static const json &name_instance(error_handler *e, const std::string &name, json &local)
+	{
+		auto store = dynamic_cast<error_store *>(e);
+		if (!store) {
+			local = name;
+			return local;
+		}
+		store->names_.push_back(std::make_shared<const json>(name));
+		return *store->names_.back();
+	}
+
+	// to be called when stored errors are reported to e
+	void hand_over(error_handler &e) const
+	{
+		if (names_.empty())
+			return;
+		if (auto store = dynamic_cast<error_store *>(&e))
+			store->names_.insert(store->names_.end(), names_.begin(), names_.end());
+	}
+};
+
+class first_error_handler : public error_store
 {
 public:
 	bool error_{false};
-	json::json_pointer ptr_;
-	json instance_;
-	std::string message_;
+	std::shared_ptr<stored_error> first_;
 
-	void error(const json::json_pointer &ptr, const json &instance, const std::string &message) override
+	// the validator reports error_records only
+	void error(const json::json_pointer &, const json &, const std::string &) override
+	{
+		error_ = true;
+	}
+
+	void error(const error_record &record) override
 	{
 		if (*this)
 			return;
 		error_ = true;
-		ptr_ = ptr;
-		instance_ = instance;
-		message_ = message;
+		first_ = std::make_shared<stored_error>(record);
 	}
 
 	operator bool() const { return error_; }
@@ -394,28 +1585,34 @@ public:
 
 class logical_not : public schema
 {
-	std::shared_ptr<schema> subschema_;
+	schema *subschema_;
 
-	void validate(const json::json_pointer &ptr, const json &instance, json_patch &patch, error_handler &e) const final
+	void validate(const instance_path &ptr, const json &instance, json_patch &patch, error_handler &e) const final
 	{
 		first_error_handler esub;
 		subschema_->validate(ptr, instance, patch, esub);
 
 		if (!esub)
-			e.error(ptr, instance, "the subschema has succeeded, but it is required to not validate");
+			e.error(error_record(error_code::not_succeeded, ptr, instance, location_));
 	}
 
-	const json &default_value(const json::json_pointer &ptr, const json &instance, error_handler &e) const override
+	const json &default_value(const instance_path &ptr, const json &instance, error_handler &e) const override
 	{
 		return subschema_->default_value(ptr, instance, e);
 	}
 
+	void compile(program_builder &b) const final
+	{
+		b.emit(opcode::not_check, b.block(subschema_));
+	}
+
 public:
 	logical_not(json &sch,
 	            root_schema *root,
 	            const std::vector<nlohmann::json_uri> &uris)
 	    : schema(root)
 	{
+		set_location(uris);
 		subschema_ = schema::make(sch, root, {"not"}, uris);
 	}
 };
@@ -426,77 +1623,106 @@ enum logical_combination_types {
 	oneOf
 };
 
-class logical_combination_error_handler : public error_handler
+class logical_combination_error_handler : public error_store
 {
 public:
-	struct error_entry
+	bool error_{false};
+	std::vector<stored_error> error_entry_list_;
+
+	// the validator reports error_records only
+	void error(const json::json_pointer &, const json &, const std::string &) override
 	{
-		json::json_pointer ptr_;
-		json instance_;
-		std::string message_;
-	};
+		error_ = true;
+	}
 
-	std::vector<error_entry> error_entry_list_;
-	
-	void error(const json::json_pointer &ptr, const json &instance, const std::string &message) override
+	void error(const error_record &record) override
 	{
-		error_entry_list_.push_back(error_entry{ ptr, instance, message });
+		error_ = true;
+		error_entry_list_.emplace_back(record);
 	}
 
-	void propagate(error_handler& e, const std::string& prefix) const
+	void propagate(error_handler &e, const std::string &prefix) const
 	{
-		for (const error_entry& entry : error_entry_list_)
-			e.error(entry.ptr_, entry.instance_, prefix + entry.message_);
+		hand_over(e);
+		for (const auto &entry : error_entry_list_)
+			entry.report(e, prefix);
 	}
-	
-	operator bool() const { return !error_entry_list_.empty(); }
+
+	operator bool() const { return error_; }
 };
 
 template <enum logical_combination_types combine_logic>
 class logical_combination : public schema
 {
-	std::vector<std::shared_ptr<schema>> subschemata_;
+	arena_vector<schema *> subschemata_;
+	json count_;
+
+	void validate(const instance_path &ptr, const json &instance, json_patch &patch, error_handler &e) const final
+	{
+		validate_cases(
+		    count_,
+		    [&](std::size_t index, error_handler &esub) { subschemata_[index]->validate(ptr, instance, patch, esub); },
+		    location_, ptr, instance, patch, e);
+	}
+
+	void compile(program_builder &b) const final
+	{
+		b.emit(op, b.combination(subschemata_));
+	}
+
+	// specialized for each of the logical_combination_types
+	static const std::string key;
+	static const opcode op;
+	static const error_code code; // none of the subschemas has succeeded
+	static bool is_validate_complete(const json &, const instance_path &, const std::string &, error_handler &, const logical_combination_error_handler &, size_t, size_t);
 
-	void validate(const json::json_pointer &ptr, const json &instance, json_patch &patch, error_handler &e) const final
+public:
+	// shared with the program, validate_case(index, error_handler) validates the instance against one subschema,
+	// cases is the number of subschemas as json as it is reported in error_records
+	template <typename ValidateCase>
+	static void validate_cases(const json &cases, const ValidateCase &validate_case, const std::string &location,
+	                           const instance_path &ptr, const json &instance, json_patch &patch, error_handler &e)
 	{
 		size_t count = 0;
-		logical_combination_error_handler error_summary;
+		// the errors of the failed cases are only reported if none succeeds
+		std::vector<std::pair<std::size_t, logical_combination_error_handler>> failed;
 
-		for (std::size_t index = 0; index < subschemata_.size(); ++index) {
-			const std::shared_ptr<schema>& s = subschemata_[index];
+		const auto n = cases.get<std::size_t>();
+		for (std::size_t index = 0; index < n; ++index) {
 			logical_combination_error_handler esub;
 			auto oldPatchSize = patch.get_json().size();
-			s->validate(ptr, instance, patch, esub);
+			validate_case(index, esub);
 			if (!esub)
 				count++;
-			else {
+			else
 				patch.get_json().get_ref<nlohmann::json::array_t &>().resize(oldPatchSize);
-				esub.propagate(error_summary, "case#" + std::to_string(index) + "] ");
-			}
 
-			if (is_validate_complete(instance, ptr, e, esub, count, index))
+			if (is_validate_complete(instance, ptr, location, e, esub, count, index))
 				return;
+
+			if (count == 0)
+				failed.emplace_back(index, std::move(esub));
 		}
 
 		if (count == 0) {
-			e.error(ptr, instance, "no subschema has succeeded, but one of them is required to validate. Type: " + key + ", number of failed subschemas: " + std::to_string(subschemata_.size()));
-			error_summary.propagate(e, "[combination: " + key + " / ");
+			e.error(error_record(code, ptr, instance, location, &cases));
+			for (const auto &f : failed)
+				f.second.propagate(e, "[combination: " + key + " / case#" + std::to_string(f.first) + "] ");
 		}
 	}
 
-	// specialized for each of the logical_combination_types
-	static const std::string key;
-	static bool is_validate_complete(const json &, const json::json_pointer &, error_handler &, const logical_combination_error_handler &, size_t, size_t);
-
 public:
 	logical_combination(json &sch,
 	                    root_schema *root,
 	                    const std::vector<nlohmann::json_uri> &uris)
-	    : schema(root)
+	    : schema(root), subschemata_(root->memory())
 	{
+		set_location(uris);
+
 		size_t c = 0;
 		for (auto &subschema : sch)
 			subschemata_.push_back(schema::make(subschema, root, {key, std::to_string(c++)}, uris));
+		count_ = subschemata_.size();
 
 		// value of allOf, anyOf, and oneOf "MUST be a non-empty array"
 		// TODO error/throw? when subschemata_.empty()
@@ -511,45 +1737,62 @@ template <>
 const std::string logical_combination<oneOf>::key = "oneOf";
 
 template <>
-bool logical_combination<allOf>::is_validate_complete(const json &, const json::json_pointer &, error_handler &e, const logical_combination_error_handler &esub, size_t, size_t current_schema_index)
+const opcode logical_combination<allOf>::op = opcode::all_of;
+template <>
+const opcode logical_combination<anyOf>::op = opcode::any_of;
+template <>
+const opcode logical_combination<oneOf>::op = opcode::one_of;
+
+// an allOf without subschemas is reported as all_of without a cause
+template <>
+const error_code logical_combination<allOf>::code = error_code::all_of;
+template <>
+const error_code logical_combination<anyOf>::code = error_code::any_of;
+template <>
+const error_code logical_combination<oneOf>::code = error_code::one_of;
+
+template <>
+bool logical_combination<allOf>::is_validate_complete(const json &, const instance_path &, const std::string &location, error_handler &e, const logical_combination_error_handler &esub, size_t, size_t current_schema_index)
 {
-	if (esub)
-	{
-		e.error(esub.error_entry_list_.front().ptr_, esub.error_entry_list_.front().instance_, "at least one subschema has failed, but all of them are required to validate - " + esub.error_entry_list_.front().message_);
+	if (esub && !esub.error_entry_list_.empty()) {
+		// reported at the first error of the failed subschema
+		esub.error_entry_list_.front().visit("", [&](const error_record &first) {
+			e.error(error_record(error_code::all_of, first.path(), first.instance(), location, nullptr, nullptr, &first));
+		});
 		esub.propagate(e, "[combination: allOf / case#" + std::to_string(current_schema_index) + "] ");
 	}
 	return esub;
 }
 
 template <>
-bool logical_combination<anyOf>::is_validate_complete(const json &, const json::json_pointer &, error_handler &, const logical_combination_error_handler &, size_t count, size_t)
+bool logical_combination<anyOf>::is_validate_complete(const json &, const instance_path &, const std::string &, error_handler &, const logical_combination_error_handler &, size_t count, size_t)
 {
 	return count == 1;
 }
 
 template <>
-bool logical_combination<oneOf>::is_validate_complete(const json &instance, const json::json_pointer &ptr, error_handler &e, const logical_combination_error_handler &, size_t count, size_t)
+bool logical_combination<oneOf>::is_validate_complete(const json &instance, const instance_path &ptr, const std::string &location, error_handler &e, const logical_combination_error_handler &, size_t count, size_t)
 {
 	if (count > 1)
-		e.error(ptr, instance, "more than one subschema has succeeded, but exactly one of them is required to validate");
+		e.error(error_record(error_code::one_of_multiple, ptr, instance, location));
 	return count > 1;
 }
 
 class type_schema : public schema
 {
-	std::vector<std::shared_ptr<schema>> type_;
+	arena_vector<schema *> type_;
 	std::pair<bool, json> enum_, const_;
-	std::vector<std::shared_ptr<schema>> logic_;
+	arena_vector<schema *> logic_;
 
-	static std::shared_ptr<schema> make(json &schema,
+	static schema *make(json &schema,
 	                                    json::value_t type,
 	                                    root_schema *,
 	                                    const std::vector<nlohmann::json_uri> &,
 	                                    std::set<std::string> &);
 
-	std::shared_ptr<schema> if_, then_, else_;
+	schema *if_ = nullptr, *then_ = nullptr, *else_ = nullptr;
 
-	void validate(const json::json_pointer &ptr, const json &instance, json_patch &patch, error_handler &e) const override final
+	void validate(const instance_path &ptr, const json &instance, json_patch &patch, error_handler &e) const override final
 	{
 		// depending on the type of instance run the type specific validator - if present
 		auto type = type_[static_cast<uint8_t>(instance.type())];
@@ -557,7 +1800,7 @@ class type_schema : public schema
 		if (type)
 			type->validate(ptr, instance, patch, e);
 		else
-			e.error(ptr, instance, "unexpected instance type");
+			e.error(error_record(error_code::unexpected_type, ptr, instance, location_));
 
 		if (enum_.first) {
 			bool seen_in_enum = false;
@@ -568,12 +1811,12 @@ class type_schema : public schema
 				}
 
 			if (!seen_in_enum)
-				e.error(ptr, instance, "instance not found in required enum");
+				e.error(error_record(error_code::not_in_enum, ptr, instance, location_, &enum_.second));
 		}
 
 		if (const_.first &&
 		    const_.second != instance)
-			e.error(ptr, instance, "instance not const");
+			e.error(error_record(error_code::not_const, ptr, instance, location_, &const_.second));
 
 		for (auto l : logic_)
 			l->validate(ptr, instance, patch, e);
@@ -595,14 +1838,36 @@ class type_schema : public schema
 		}
 	}
 
+	void compile(program_builder &b) const override final
+	{
+		program::type_table types;
+		for (std::size_t t = 0; t < types.size(); ++t)
+			types[t] = b.block(type_[t]);
+		b.emit(opcode::type_dispatch, b.add(types));
+
+		if (enum_.first)
+			b.emit(opcode::enum_check, b.enumeration(enum_.second));
+
+		if (const_.first)
+			b.emit(opcode::const_check, b.constant(const_.second));
+
+		for (auto l : logic_) // allOf, anyOf, oneOf and not are inlined into this block
+			l->compile(b);
+
+		if (if_)
+			b.emit(opcode::if_then_else, b.add(program::conditional{b.block(if_), b.block(then_), b.block(else_)}));
+
+		b.emit(opcode::null_default, b.constant(default_value_));
+	}
+
 protected:
-	virtual std::shared_ptr<schema> make_for_default_(
-	    std::shared_ptr<::schema> & /* sch */,
+	schema *make_for_default_(
+	    schema * /* sch */,
 	    root_schema * /* root */,
 	    std::vector<nlohmann::json_uri> & /* uris */,
 	    nlohmann::json &default_value) const override
 	{
-		auto result = std::make_shared<type_schema>(*this);
+		auto result = root_->create<type_schema>(*this);
 		result->set_default_value(default_value);
 		return result;
 	};
@@ -611,8 +1876,10 @@ public:
 	type_schema(json &sch,
 	            root_schema *root,
 	            const std::vector<nlohmann::json_uri> &uris)
-	    : schema(root), type_(static_cast<uint8_t>(json::value_t::discarded) + 1)
+	    : schema(root), type_(static_cast<uint8_t>(json::value_t::discarded) + 1, nullptr, root->memory()), logic_(root->memory())
 	{
+		set_location(uris);
+
 		// association between JSON-schema-type and NLohmann-types
 		static const std::vector<std::pair<std::string, json::value_t>> schema_types = {
 		    {"null", json::value_t::null},
@@ -693,25 +1960,25 @@ public:
 
 		attr = sch.find("not");
 		if (attr != sch.end()) {
-			logic_.push_back(std::make_shared<logical_not>(attr.value(), root, uris));
+			logic_.push_back(root->create<logical_not>(attr.value(), root, uris));
 			sch.erase(attr);
 		}
 
 		attr = sch.find("allOf");
 		if (attr != sch.end()) {
-			logic_.push_back(std::make_shared<logical_combination<allOf>>(attr.value(), root, uris));
+			logic_.push_back(root->create<logical_combination<allOf>>(attr.value(), root, uris));
 			sch.erase(attr);
 		}
 
 		attr = sch.find("anyOf");
 		if (attr != sch.end()) {
-			logic_.push_back(std::make_shared<logical_combination<anyOf>>(attr.value(), root, uris));
+			logic_.push_back(root->create<logical_combination<anyOf>>(attr.value(), root, uris));
 			sch.erase(attr);
 		}
 
 		attr = sch.find("oneOf");
 		if (attr != sch.end()) {
-			logic_.push_back(std::make_shared<logical_combination<oneOf>>(attr.value(), root, uris));
+			logic_.push_back(root->create<logical_combination<oneOf>>(attr.value(), root, uris));
 			sch.erase(attr);
 		}
 
@@ -740,56 +2007,41 @@ public:
 
 class string : public schema
 {
-	std::pair<bool, size_t> maxLength_{false, 0};
-	std::pair<bool, size_t> minLength_{false, 0};
+	std::pair<bool, json> maxLength_{false, 0};
+	std::pair<bool, json> minLength_{false, 0};
 
 #ifndef NO_STD_REGEX
-	std::pair<bool, REGEX_NAMESPACE::regex> pattern_{false, REGEX_NAMESPACE::regex()};
-	std::string patternString_;
+	std::shared_ptr<const schema_regex> pattern_;
+	json patternString_;
 #endif
 
-	std::pair<bool, std::string> format_;
+	std::pair<bool, json> format_;
+	format_value_checker formatCheck_;
 	std::tuple<bool, std::string, std::string> content_{false, "", ""};
+	json contentKeywords_; // [contentEncoding, contentMediaType] as reported in error_records
 
-	std::size_t utf8_length(const std::string &s) const
-	{
-		size_t len = 0;
-		for (auto c : s)
-			if ((c & 0xc0) != 0x80)
-				len++;
-		return len;
-	}
-
-	void validate(const json::json_pointer &ptr, const json &instance, json_patch &, error_handler &e) const override
+	void validate(const instance_path &ptr, const json &instance, json_patch &, error_handler &e) const override
 	{
-		if (minLength_.first) {
-			if (utf8_length(instance.get<std::string>()) < minLength_.second) {
-				std::ostringstream s;
-				s << "instance is too short as per minLength:" << minLength_.second;
-				e.error(ptr, instance, s.str());
-			}
-		}
-
-		if (maxLength_.first) {
-			if (utf8_length(instance.get<std::string>()) > maxLength_.second) {
-				std::ostringstream s;
-				s << "instance is too long as per maxLength: " << maxLength_.second;
-				e.error(ptr, instance, s.str());
-			}
+		if (minLength_.first || maxLength_.first) {
+			string_length length(instance.get_ref<const json::string_t &>());
+			if (minLength_.first && length.below(minLength_.second.get<std::size_t>()))
+				e.error(error_record(error_code::min_length, ptr, instance, location_, &minLength_.second));
+			if (maxLength_.first && length.above(maxLength_.second.get<std::size_t>()))
+				e.error(error_record(error_code::max_length, ptr, instance, location_, &maxLength_.second));
 		}
 
 		if (std::get<0>(content_)) {
 			if (root_->content_check() == nullptr)
-				e.error(ptr, instance, std::string("a content checker was not provided but a contentEncoding or contentMediaType for this string have been present: '") + std::get<1>(content_) + "' '" + std::get<2>(content_) + "'");
+				e.error(error_record(error_code::content_checker_missing, ptr, instance, location_, &contentKeywords_));
 			else {
-				try {
-					root_->content_check()(std::get<1>(content_), std::get<2>(content_), instance);
-				} catch (const std::exception &ex) {
-					e.error(ptr, instance, std::string("content-checking failed: ") + ex.what());
+				auto status = root_->content_check().check(std::get<1>(content_), std::get<2>(content_), instance);
+				if (!status.ok()) {
+					const std::string what = status.message();
+					e.error(error_record(error_code::content, ptr, instance, location_, &contentKeywords_, &what));
 				}
 			}
 		} else if (instance.type() == json::value_t::binary) {
-			e.error(ptr, instance, "expected string, but get binary data");
+			e.error(error_record(error_code::unexpected_binary, ptr, instance, location_));
 		}
 
 		if (instance.type() != json::value_t::string) {
@@ -797,24 +2049,45 @@ class string : public schema
 		}
 
 #ifndef NO_STD_REGEX
-		if (pattern_.first &&
-		    !REGEX_NAMESPACE::regex_search(instance.get<std::string>(), pattern_.second))
-			e.error(ptr, instance, "instance does not match regex pattern: " + patternString_);
+		if (pattern_ && !pattern_->search(instance.get_ref<const json::string_t &>()))
+			e.error(error_record(error_code::pattern, ptr, instance, location_, &patternString_));
 #endif
 
 		if (format_.first) {
-			if (root_->format_check() == nullptr)
-				e.error(ptr, instance, std::string("a format checker was not provided but a format keyword for this string is present: ") + format_.second);
+			if (formatCheck_ == nullptr)
+				e.error(error_record(error_code::format_checker_missing, ptr, instance, location_, &format_.second));
 			else {
-				try {
-					root_->format_check()(format_.second, instance.get<std::string>());
-				} catch (const std::exception &ex) {
-					e.error(ptr, instance, std::string("format-checking failed: ") + ex.what());
+				auto status = formatCheck_.check(instance.get_ref<const json::string_t &>());
+				if (!status.ok()) {
+					const std::string what = status.message();
+					e.error(error_record(error_code::format, ptr, instance, location_, &format_.second, &what));
 				}
 			}
 		}
 	}
 
+	void compile(program_builder &b) const override
+	{
+		if (minLength_.first || maxLength_.first)
+			b.emit(opcode::string_length, b.add(program::length_bounds{
+			                                  minLength_.second.get<std::size_t>(), maxLength_.second.get<std::size_t>(),
+			                                  minLength_.first ? &minLength_.second : nullptr,
+			                                  maxLength_.first ? &maxLength_.second : nullptr}));
+
+		if (std::get<0>(content_))
+			b.emit(opcode::content, b.add(program::content{std::get<1>(content_), std::get<2>(content_), contentKeywords_}));
+		else
+			b.emit(opcode::binary_rejected);
+
+#ifndef NO_STD_REGEX
+		if (pattern_)
+			b.emit(opcode::pattern, b.add(program::pattern{pattern_.get(), &patternString_}));
+#endif
+
+		if (format_.first)
+			b.emit(opcode::format, b.add(program::format{&formatCheck_, &format_.second}));
+	}
+
 public:
 	string(json &sch, root_schema *root)
 	    : schema(root)
@@ -861,83 +2134,43 @@ public:
 		if (std::get<0>(content_) == true && root_->content_check() == nullptr) {
 			throw std::invalid_argument{"schema contains contentEncoding/contentMediaType but content checker was not set"};
 		}
+		contentKeywords_ = {std::get<1>(content_), std::get<2>(content_)};
 
-#ifndef NO_STD_REGEX
-		attr = sch.find("pattern");
-		if (attr != sch.end()) {
-			patternString_ = attr.value().get<std::string>();
-			pattern_ = {true, REGEX_NAMESPACE::regex(attr.value().get<std::string>(),
-			                                         REGEX_NAMESPACE::regex::ECMAScript)};
-			sch.erase(attr);
-		}
-#endif
-
-		attr = sch.find("format");
-		if (attr != sch.end()) {
-			if (root_->format_check() == nullptr)
-				throw std::invalid_argument{"a format checker was not provided but a format keyword for this string is present: " + format_.second};
-
-			format_ = {true, attr.value().get<std::string>()};
-			sch.erase(attr);
-		}
-	}
-};
-
-template <typename T>
-class numeric : public schema
-{
-	std::pair<bool, T> maximum_{false, 0};
-	std::pair<bool, T> minimum_{false, 0};
-
-	bool exclusiveMaximum_ = false;
-	bool exclusiveMinimum_ = false;
-
-	std::pair<bool, json::number_float_t> multipleOf_{false, 0};
-
-	// multipleOf - if the remainder of the division is 0 -> OK
-	bool violates_multiple_of(T x) const
-	{
-		double res = std::remainder(x, multipleOf_.second);
-		double multiple = std::fabs(x / multipleOf_.second);
-		if (multiple > 1) {
-			res = res / multiple;
-		}
-		double eps = std::nextafter(x, 0) - static_cast<double>(x);
-
-		return std::fabs(res) > std::fabs(eps);
-	}
-
-	void validate(const json::json_pointer &ptr, const json &instance, json_patch &, error_handler &e) const override
-	{
-		T value = instance; // conversion of json to value_type
-
-		std::ostringstream oss;
-
-		if (multipleOf_.first && value != 0) // zero is multiple of everything
-			if (violates_multiple_of(value))
-				oss << "instance is not a multiple of " << json(multipleOf_.second);
-
-		if (maximum_.first) {
-			if (exclusiveMaximum_ && value >= maximum_.second)
-				oss << "instance exceeds or equals maximum of " << json(maximum_.second);
-			else if (value > maximum_.second)
-				oss << "instance exceeds maximum of " << json(maximum_.second);
-		}
-
-		if (minimum_.first) {
-			if (exclusiveMinimum_ && value <= minimum_.second)
-				oss << "instance is below or equals minimum of " << json(minimum_.second);
-			else if (value < minimum_.second)
-				oss << "instance is below minimum of " << json(minimum_.second);
+#ifndef NO_STD_REGEX
+		attr = sch.find("pattern");
+		if (attr != sch.end()) {
+			patternString_ = attr.value();
+			pattern_ = schema_regex::intern(attr.value().get<std::string>());
+			sch.erase(attr);
 		}
+#endif
 
-		oss.seekp(0, std::ios::end);
-		auto size = oss.tellp();
-		if (size != 0) {
-			oss.seekp(0, std::ios::beg);
-			e.error(ptr, instance, oss.str());
+		attr = sch.find("format");
+		if (attr != sch.end()) {
+			formatCheck_ = root_->bind_format(attr.value().get<std::string>());
+			if (formatCheck_ == nullptr)
+				throw std::invalid_argument{"a format checker was not provided but a format keyword for this string is present: " + attr.value().get<std::string>()};
+
+			format_ = {true, attr.value().get<std::string>()};
+			sch.erase(attr);
 		}
 	}
+};
+
+template <typename T>
+class numeric : public schema
+{
+	numeric_keywords<T> kw_;
+
+	void validate(const instance_path &ptr, const json &instance, json_patch &, error_handler &e) const override
+	{
+		kw_.validate(ptr, instance, location_, e);
+	}
+
+	void compile(program_builder &b) const override
+	{
+		b.emit(std::is_floating_point<T>::value ? opcode::numeric_float : opcode::numeric_integer, b.add(kw_));
+	}
 
 public:
 	numeric(const json &sch, root_schema *root, std::set<std::string> &kw)
@@ -945,44 +2178,51 @@ public:
 	{
 		auto attr = sch.find("maximum");
 		if (attr != sch.end()) {
-			maximum_ = {true, attr.value().get<T>()};
+			kw_.maximum_ = {true, attr.value().get<T>()};
 			kw.insert("maximum");
 		}
 
 		attr = sch.find("minimum");
 		if (attr != sch.end()) {
-			minimum_ = {true, attr.value().get<T>()};
+			kw_.minimum_ = {true, attr.value().get<T>()};
 			kw.insert("minimum");
 		}
 
 		attr = sch.find("exclusiveMaximum");
 		if (attr != sch.end()) {
-			exclusiveMaximum_ = true;
-			maximum_ = {true, attr.value().get<T>()};
+			kw_.exclusiveMaximum_ = true;
+			kw_.maximum_ = {true, attr.value().get<T>()};
 			kw.insert("exclusiveMaximum");
 		}
 
 		attr = sch.find("exclusiveMinimum");
 		if (attr != sch.end()) {
-			exclusiveMinimum_ = true;
-			minimum_ = {true, attr.value().get<T>()};
+			kw_.exclusiveMinimum_ = true;
+			kw_.minimum_ = {true, attr.value().get<T>()};
 			kw.insert("exclusiveMinimum");
 		}
 
 		attr = sch.find("multipleOf");
 		if (attr != sch.end()) {
-			multipleOf_ = {true, attr.value().get<json::number_float_t>()};
+			kw_.multipleOf_ = {true, attr.value().get<json::number_float_t>()};
 			kw.insert("multipleOf");
 		}
+
+		kw_.set_limits();
 	}
 };
 
 class null : public schema
 {
-	void validate(const json::json_pointer &ptr, const json &instance, json_patch &, error_handler &e) const override
+	void validate(const instance_path &ptr, const json &instance, json_patch &, error_handler &e) const override
 	{
 		if (!instance.is_null())
-			e.error(ptr, instance, "expected to be null");
+			e.error(error_record(error_code::expected_null, ptr, instance, location_));
+	}
+
+	void compile(program_builder &b) const override
+	{
+		b.emit(opcode::expect_null);
 	}
 
 public:
@@ -992,7 +2232,9 @@ public:
 
 class boolean_type : public schema
 {
-	void validate(const json::json_pointer &, const json &, json_patch &, error_handler &) const override {}
+	void validate(const instance_path &, const json &, json_patch &, error_handler &) const override {}
+
+	void compile(program_builder &) const override {}
 
 public:
 	boolean_type(json &, root_schema *root)
@@ -1002,7 +2244,7 @@ public:
 class boolean : public schema
 {
 	bool true_;
-	void validate(const json::json_pointer &ptr, const json &instance, json_patch &, error_handler &e) const override
+	void validate(const instance_path &ptr, const json &instance, json_patch &, error_handler &e) const override
 	{
 		if (!true_) { // false schema
 			// empty array
@@ -1013,10 +2255,16 @@ class boolean : public schema
 			//	return;
 			//}
 
-			e.error(ptr, instance, "instance invalid as per false-schema");
+			e.error(error_record(error_code::false_schema, ptr, instance, location_));
 		}
 	}
 
+	void compile(program_builder &b) const override
+	{
+		if (!true_)
+			b.emit(opcode::false_schema);
+	}
+
 public:
 	boolean(json &sch, root_schema *root)
 	    : schema(root), true_(sch) {}
@@ -1024,76 +2272,97 @@ public:
 
 class required : public schema
 {
-	const std::vector<std::string> required_;
+	const arena_vector<std::string> required_;
 
-	void validate(const json::json_pointer &ptr, const json &instance, json_patch &, error_handler &e) const override final
+	void validate(const instance_path &ptr, const json &instance, json_patch &, error_handler &e) const override final
 	{
 		for (auto &r : required_)
 			if (instance.find(r) == instance.end())
-				e.error(ptr, instance, "required property '" + r + "' not found in object as a dependency");
+				e.error(error_record(error_code::dependency_required, ptr, instance, location_, nullptr, &r));
+	}
+
+	void compile(program_builder &b) const override final
+	{
+		b.emit(opcode::dependency_required, b.strings(required_));
 	}
 
 public:
-	required(const std::vector<std::string> &r, root_schema *root)
-	    : schema(root), required_(r) {}
+	required(const std::vector<std::string> &r, root_schema *root, const std::vector<nlohmann::json_uri> &uris)
+	    : schema(root), required_(r.begin(), r.end(), root->memory())
+	{
+		set_location(uris);
+	}
 };
 
 class object : public schema
 {
-	std::pair<bool, size_t> maxProperties_{false, 0};
-	std::pair<bool, size_t> minProperties_{false, 0};
-	std::vector<std::string> required_;
+	std::pair<bool, json> maxProperties_{false, 0};
+	std::pair<bool, json> minProperties_{false, 0};
+	arena_vector<std::string> required_;
 
-	std::map<std::string, std::shared_ptr<schema>> properties_;
+	arena_map<schema *> properties_;
 #ifndef NO_STD_REGEX
-	std::vector<std::pair<REGEX_NAMESPACE::regex, std::shared_ptr<schema>>> patternProperties_;
+	std::shared_ptr<const schema_regex_set> patterns_;
+	arena_vector<schema *> patternProperties_; // per pattern
 #endif
-	std::shared_ptr<schema> additionalProperties_;
+	schema *additionalProperties_ = nullptr;
 
-	std::map<std::string, std::shared_ptr<schema>> dependencies_;
+	arena_map<schema *> dependencies_;
 
-	std::shared_ptr<schema> propertyNames_;
+	schema *propertyNames_ = nullptr;
 
-	void validate(const json::json_pointer &ptr, const json &instance, json_patch &patch, error_handler &e) const override
+	void validate(const instance_path &ptr, const json &instance, json_patch &patch, error_handler &e) const override
 	{
 		if (maxProperties_.first && instance.size() > maxProperties_.second)
-			e.error(ptr, instance, "too many properties");
+			e.error(error_record(error_code::max_properties, ptr, instance, location_, &maxProperties_.second));
 
 		if (minProperties_.first && instance.size() < minProperties_.second)
-			e.error(ptr, instance, "too few properties");
+			e.error(error_record(error_code::min_properties, ptr, instance, location_, &minProperties_.second));
 
 		for (auto &r : required_)
 			if (instance.find(r) == instance.end())
-				e.error(ptr, instance, "required property '" + r + "' not found in object");
+				e.error(error_record(error_code::required, ptr, instance, location_, nullptr, &r));
+
+#ifndef NO_STD_REGEX
+		std::vector<std::size_t> matched_patterns;
+#endif
 
 		// for each property in instance
 		for (auto &p : instance.items()) {
-			if (propertyNames_)
-				propertyNames_->validate(ptr, p.key(), patch, e);
+			if (propertyNames_) {
+				json name;
+				propertyNames_->validate(ptr, error_store::name_instance(&e, p.key(), name), patch, e);
+			}
 
 			bool a_prop_or_pattern_matched = false;
 			auto schema_p = properties_.find(p.key());
 			// check if it is in "properties"
 			if (schema_p != properties_.end()) {
 				a_prop_or_pattern_matched = true;
-				schema_p->second->validate(ptr / p.key(), p.value(), patch, e);
+				schema_p->second->validate(instance_path(ptr, p.key()), p.value(), patch, e);
 			}
 
 #ifndef NO_STD_REGEX
 			// check all matching patternProperties
-			for (auto &schema_pp : patternProperties_)
-				if (REGEX_NAMESPACE::regex_search(p.key(), schema_pp.first)) {
+			if (patterns_) {
+				patterns_->search(p.key(), matched_patterns);
+				for (auto i : matched_patterns) {
 					a_prop_or_pattern_matched = true;
-					schema_pp.second->validate(ptr / p.key(), p.value(), patch, e);
+					patternProperties_[i]->validate(instance_path(ptr, p.key()), p.value(), patch, e);
 				}
+			}
 #endif
 
 			// check additionalProperties as a last resort
 			if (!a_prop_or_pattern_matched && additionalProperties_) {
 				first_error_handler additional_prop_err;
-				additionalProperties_->validate(ptr / p.key(), p.value(), patch, additional_prop_err);
-				if (additional_prop_err)
-					e.error(ptr, instance, "validation failed for additional property '" + p.key() + "': " + additional_prop_err.message_);
+				additionalProperties_->validate(instance_path(ptr, p.key()), p.value(), patch, additional_prop_err);
+				if (additional_prop_err) {
+					additional_prop_err.hand_over(e);
+					additional_prop_err.first_->visit("", [&](const error_record &cause) {
+						e.error(error_record(error_code::additional_properties, ptr, instance, location_, nullptr, &p.key(), &cause));
+					});
+				}
 			}
 		}
 
@@ -1103,7 +2372,7 @@ class object : public schema
 			if (instance.end() == finding) { // if the prop is not in the instance
 				const auto &default_value = prop.second->default_value(ptr, instance, e);
 				if (!default_value.is_null()) { // if default value is available
-					patch.add((ptr / prop.first), default_value);
+					patch.add((ptr.to_pointer() / prop.first), default_value);
 				}
 			}
 		}
@@ -1111,15 +2380,44 @@ class object : public schema
 		for (auto &dep : dependencies_) {
 			auto prop = instance.find(dep.first);
 			if (prop != instance.end())                                    // if dependency-property is present in instance
-				dep.second->validate(ptr / dep.first, instance, patch, e); // validate
+				dep.second->validate(instance_path(ptr, dep.first), instance, patch, e); // validate
 		}
 	}
 
+	void compile(program_builder &b) const override
+	{
+		if (maxProperties_.first)
+			b.emit(opcode::max_properties, b.size(maxProperties_.second));
+
+		if (minProperties_.first)
+			b.emit(opcode::min_properties, b.size(minProperties_.second));
+
+		program::object_layout layout{};
+		b.object_keys(properties_, dependencies_, required_, layout);
+#ifndef NO_STD_REGEX
+		layout.pattern_properties = b.blocks(patternProperties_);
+		layout.patterns = patterns_.get();
+#endif
+		layout.additional_properties = b.block(additionalProperties_);
+		layout.property_names = b.block(propertyNames_);
+		layout.members = !properties_.empty() ||
+		                 layout.pattern_properties.begin != layout.pattern_properties.end ||
+		                 layout.additional_properties != no_block ||
+		                 layout.property_names != no_block;
+
+		if (layout.lookups || layout.members)
+			b.emit(opcode::object_members, b.add(layout));
+	}
+
 public:
 	object(json &sch,
 	       root_schema *root,
 	       const std::vector<nlohmann::json_uri> &uris)
-	    : schema(root)
+	    : schema(root), required_(root->memory()), properties_(root->memory()),
+#ifndef NO_STD_REGEX
+	      patternProperties_(root->memory()),
+#endif
+	      dependencies_(root->memory())
 	{
 		auto attr = sch.find("maxProperties");
 		if (attr != sch.end()) {
@@ -1135,7 +2433,8 @@ public:
 
 		attr = sch.find("required");
 		if (attr != sch.end()) {
-			required_ = attr.value().get<std::vector<std::string>>();
+			auto required = attr.value().get<std::vector<std::string>>();
+			required_.assign(required.begin(), required.end());
 			sch.erase(attr);
 		}
 
@@ -1152,11 +2451,12 @@ public:
 #ifndef NO_STD_REGEX
 		attr = sch.find("patternProperties");
 		if (attr != sch.end()) {
-			for (auto prop : attr.value().items())
-				patternProperties_.push_back(
-				    std::make_pair(
-				        REGEX_NAMESPACE::regex(prop.key(), REGEX_NAMESPACE::regex::ECMAScript),
-				        schema::make(prop.value(), root, {prop.key()}, uris)));
+			std::vector<std::string> patterns;
+			for (auto prop : attr.value().items()) {
+				patterns.push_back(prop.key());
+				patternProperties_.push_back(schema::make(prop.value(), root, {prop.key()}, uris));
+			}
+			patterns_ = schema_regex_set::intern(patterns);
 			sch.erase(attr);
 		}
 #endif
@@ -1173,8 +2473,8 @@ public:
 				switch (dep.value().type()) {
 				case json::value_t::array:
 					dependencies_.emplace(dep.key(),
-					                      std::make_shared<required>(
-					                          dep.value().get<std::vector<std::string>>(), root));
+					                      root->create<required>(
+					                          dep.value().get<std::vector<std::string>>(), root, uris));
 					break;
 
 				default:
@@ -1200,43 +2500,38 @@ public:
 
 class array : public schema
 {
-	std::pair<bool, size_t> maxItems_{false, 0};
-	std::pair<bool, size_t> minItems_{false, 0};
+	std::pair<bool, json> maxItems_{false, 0};
+	std::pair<bool, json> minItems_{false, 0};
 	bool uniqueItems_ = false;
 
-	std::shared_ptr<schema> items_schema_;
+	schema *items_schema_ = nullptr;
 
-	std::vector<std::shared_ptr<schema>> items_;
-	std::shared_ptr<schema> additionalItems_;
+	arena_vector<schema *> items_;
+	schema *additionalItems_ = nullptr;
 
-	std::shared_ptr<schema> contains_;
+	schema *contains_ = nullptr;
 
-	void validate(const json::json_pointer &ptr, const json &instance, json_patch &patch, error_handler &e) const override
+	void validate(const instance_path &ptr, const json &instance, json_patch &patch, error_handler &e) const override
 	{
 		if (maxItems_.first && instance.size() > maxItems_.second)
-			e.error(ptr, instance, "array has too many items");
+			e.error(error_record(error_code::max_items, ptr, instance, location_, &maxItems_.second));
 
 		if (minItems_.first && instance.size() < minItems_.second)
-			e.error(ptr, instance, "array has too few items");
+			e.error(error_record(error_code::min_items, ptr, instance, location_, &minItems_.second));
 
-		if (uniqueItems_) {
-			for (auto it = instance.cbegin(); it != instance.cend(); ++it) {
-				auto v = std::find(it + 1, instance.end(), *it);
-				if (v != instance.end())
-					e.error(ptr, instance, "items have to be unique for this array");
-			}
-		}
+		if (uniqueItems_ && has_duplicate_items(instance))
+			e.error(error_record(error_code::unique_items, ptr, instance, location_));
 
 		size_t index = 0;
 		if (items_schema_)
 			for (auto &i : instance) {
-				items_schema_->validate(ptr / index, i, patch, e);
+				items_schema_->validate(instance_path(ptr, index), i, patch, e);
 				index++;
 			}
 		else {
 			auto item = items_.cbegin();
 			for (auto &i : instance) {
-				std::shared_ptr<schema> item_validator;
+				schema *item_validator;
 				if (item == items_.cend())
 					item_validator = additionalItems_;
 				else {
@@ -1247,7 +2542,8 @@ class array : public schema
 				if (!item_validator)
 					break;
 
-				item_validator->validate(ptr / index, i, patch, e);
+				item_validator->validate(instance_path(ptr, index), i, patch, e);
+				index++;
 			}
 		}
 
@@ -1262,13 +2558,33 @@ class array : public schema
 				}
 			}
 			if (!contained)
-				e.error(ptr, instance, "array does not contain required element as per 'contains'");
+				e.error(error_record(error_code::contains, ptr, instance, location_));
 		}
 	}
 
+	void compile(program_builder &b) const override
+	{
+		if (maxItems_.first)
+			b.emit(opcode::max_items, b.size(maxItems_.second));
+
+		if (minItems_.first)
+			b.emit(opcode::min_items, b.size(minItems_.second));
+
+		if (uniqueItems_)
+			b.emit(opcode::unique_items);
+
+		if (items_schema_)
+			b.emit(opcode::items, b.block(items_schema_));
+		else if (!items_.empty() || additionalItems_)
+			b.emit(opcode::tuple_items, b.add(program::tuple_layout{b.blocks(items_), b.block(additionalItems_)}));
+
+		if (contains_)
+			b.emit(opcode::contains, b.block(contains_));
+	}
+
 public:
 	array(json &sch, root_schema *root, const std::vector<nlohmann::json_uri> &uris)
-	    : schema(root)
+	    : schema(root), items_(root->memory())
 	{
 		auto attr = sch.find("maxItems");
 		if (attr != sch.end()) {
@@ -1317,29 +2633,38 @@ public:
 	}
 };
 
-std::shared_ptr<schema> type_schema::make(json &schema,
-                                          json::value_t type,
-                                          root_schema *root,
-                                          const std::vector<nlohmann::json_uri> &uris,
-                                          std::set<std::string> &kw)
+schema *type_schema::make(json &schema,
+                          json::value_t type,
+                          root_schema *root,
+                          const std::vector<nlohmann::json_uri> &uris,
+                          std::set<std::string> &kw)
 {
+	::schema *sch = nullptr;
+
 	switch (type) {
 	case json::value_t::null:
-		return std::make_shared<null>(schema, root);
+		sch = root->create<null>(schema, root);
+		break;
 
 	case json::value_t::number_unsigned:
 	case json::value_t::number_integer:
-		return std::make_shared<numeric<json::number_integer_t>>(schema, root, kw);
+		sch = root->create<numeric<json::number_integer_t>>(schema, root, kw);
+		break;
 	case json::value_t::number_float:
-		return std::make_shared<numeric<json::number_float_t>>(schema, root, kw);
+		sch = root->create<numeric<json::number_float_t>>(schema, root, kw);
+		break;
 	case json::value_t::string:
-		return std::make_shared<string>(schema, root);
+		sch = root->create<string>(schema, root);
+		break;
 	case json::value_t::boolean:
-		return std::make_shared<boolean_type>(schema, root);
+		sch = root->create<boolean_type>(schema, root);
+		break;
 	case json::value_t::object:
-		return std::make_shared<object>(schema, root, uris);
+		sch = root->create<object>(schema, root, uris);
+		break;
 	case json::value_t::array:
-		return std::make_shared<array>(schema, root, uris);
+		sch = root->create<array>(schema, root, uris);
+		break;
 
 	case json::value_t::discarded: // not a real type - silence please
 		break;
@@ -1347,17 +2672,603 @@ std::shared_ptr<schema> type_schema::make(json &schema,
 	case json::value_t::binary:
 		break;
 	}
+
+	if (sch)
+		sch->set_location(uris);
+	return sch;
+}
+
+const program::object_key *program::find_key(const range &r, const std::string &name) const
+{
+	auto first = object_keys_.begin() + r.begin, last = object_keys_.begin() + r.end;
+	auto found = std::lower_bound(first, last, name,
+	                              [](const object_key &k, const std::string &n) { return k.name < n; });
+	if (found != last && found->name == name)
+		return &*found;
 	return nullptr;
 }
+
+const program::range &program::candidates(const dispatch &d, const json &instance) const
+{
+	if (d.property.empty() || !instance.is_object())
+		return d.types[static_cast<std::size_t>(instance.type())];
+
+	auto value = instance.find(d.property);
+	if (value == instance.end())
+		return d.absent;
+	if (value->is_string()) {
+		auto known = d.values.find(value->get_ref<const std::string &>());
+		if (known != d.values.end())
+			return known->second;
+	}
+	return d.other_value;
+}
+
+template <typename Validate>
+bool program::in_parallel(thread_pool &pool, std::size_t n, json_patch *patch, error_handler *e, const Validate &validate) const
+{
+	const auto chunks = std::min(n, (pool.size() + 1) * 4);
+	std::vector<logical_combination_error_handler> errors(e ? chunks : 0);
+	std::vector<json_patch> patches(patch ? chunks : 0);
+	std::atomic<bool> failed{false}; // only without an error_handler
+
+	pool.parallel_for(chunks, [&](std::size_t c) {
+		for (auto i = n * c / chunks; i < n * (c + 1) / chunks && !failed; ++i)
+			if (!validate(i, patch ? &patches[c] : nullptr, e ? &errors[c] : nullptr))
+				failed = true;
+	});
+	if (failed)
+		return false;
+
+	for (std::size_t c = 0; c < chunks; ++c) {
+		if (e)
+			errors[c].propagate(*e, "");
+		if (patch)
+			for (auto &operation : patches[c].get_json())
+				patch->get_json().push_back(std::move(operation));
+	}
+	return true;
+}
+
+bool program::run(std::uint32_t block, const instance_path &ptr, const json &instance, json_patch *patch, error_handler *e) const
+{
+	const auto &b = blocks_[block];
+	const auto &location = *locations_[block];
+
+	for (auto pc = b.begin; pc != b.end; ++pc) {
+		const auto operand = code_[pc].operand;
+
+		switch (code_[pc].op) {
+		case opcode::unresolved_reference:
+			if (!e)
+				return false;
+			e->error(error_record(error_code::unresolved_reference, ptr, instance, location, nullptr, &strings_[operand]));
+			break;
+
+		case opcode::false_schema:
+			if (!e)
+				return false;
+			e->error(error_record(error_code::false_schema, ptr, instance, location));
+			break;
+
+		case opcode::type_dispatch: {
+			// depending on the type of instance run the type specific validator - if present
+			auto type = types_[operand][static_cast<uint8_t>(instance.type())];
+
+			if (type != no_block) {
+				if (!run(type, ptr, instance, patch, e))
+					return false;
+			} else {
+				if (!e)
+					return false;
+				e->error(error_record(error_code::unexpected_type, ptr, instance, location));
+			}
+		} break;
+
+		case opcode::enum_check: {
+			const auto &index = enums_[operand];
+			const auto &values = constants_[index.values];
+
+			// values of other types than the instance's are not compared at all
+			bool seen_in_enum = false;
+			if (index.hashes.empty() && (index.types & type_bit(instance.type()))) {
+				for (auto &v : values)
+					if (instance == v) {
+						seen_in_enum = true;
+						break;
+					}
+			} else if (index.types & type_bit(instance.type())) {
+				const auto hash = json_hash(instance);
+				for (auto h = std::lower_bound(index.hashes.begin(), index.hashes.end(), std::make_pair(hash, std::uint32_t(0)));
+				     h != index.hashes.end() && h->first == hash; ++h)
+					if (instance == values[h->second]) {
+						seen_in_enum = true;
+						break;
+					}
+			}
+
+			if (!seen_in_enum) {
+				if (!e)
+					return false;
+				e->error(error_record(error_code::not_in_enum, ptr, instance, location, &values));
+			}
+		} break;
+
+		case opcode::const_check:
+			if (constants_[operand] != instance) {
+				if (!e)
+					return false;
+				e->error(error_record(error_code::not_const, ptr, instance, location, &constants_[operand]));
+			}
+			break;
+
+		case opcode::not_check: {
+			bool succeeded;
+			if (e) {
+				first_error_handler esub;
+				run(operand, ptr, instance, patch, &esub);
+				succeeded = !esub;
+			} else
+				succeeded = run(operand, ptr, instance, nullptr, nullptr);
+
+			if (succeeded) {
+				if (!e)
+					return false;
+				e->error(error_record(error_code::not_succeeded, ptr, instance, location));
+			}
+		} break;
+
+		case opcode::all_of:
+		case opcode::any_of:
+		case opcode::one_of: {
+			const auto &combined = combinations_[operand];
+			const auto &cases = combined.dispatch == no_block ? combined.cases : candidates(dispatches_[combined.dispatch], instance);
+
+			if (!e) {
+				std::size_t count = 0;
+				for (auto c = cases.begin; c != cases.end; ++c) {
+					if (run(block_lists_[c], ptr, instance, nullptr, nullptr))
+						count++;
+					else if (code_[pc].op == opcode::all_of)
+						return false;
+
+					if (code_[pc].op == opcode::any_of && count == 1)
+						break;
+					if (code_[pc].op == opcode::one_of && count > 1)
+						return false;
+				}
+				if (count == 0)
+					return false;
+				break;
+			}
+
+			// the candidates decide unless none of them succeeds, then all cases
+			// are run for reporting their errors
+			if (combined.dispatch != no_block) {
+				std::size_t count = 0;
+				for (auto c = cases.begin; c != cases.end; ++c) {
+					first_error_handler esub;
+					auto oldPatchSize = patch->get_json().size();
+					run(block_lists_[c], ptr, instance, patch, &esub);
+					if (!esub)
+						count++;
+					else
+						patch->get_json().get_ref<nlohmann::json::array_t &>().resize(oldPatchSize);
+
+					if (code_[pc].op == opcode::any_of && count == 1)
+						break;
+					if (code_[pc].op == opcode::one_of && count > 1) {
+						e->error(error_record(error_code::one_of_multiple, ptr, instance, location));
+						break;
+					}
+				}
+				if (count > 0)
+					break;
+			}
+
+			auto validate_case = [&](std::size_t index, error_handler &esub) {
+				run(block_lists_[combined.cases.begin + index], ptr, instance, patch, &esub);
+			};
+
+			const auto &count = combined.count;
+			if (code_[pc].op == opcode::all_of)
+				logical_combination<allOf>::validate_cases(count, validate_case, location, ptr, instance, *patch, *e);
+			else if (code_[pc].op == opcode::any_of)
+				logical_combination<anyOf>::validate_cases(count, validate_case, location, ptr, instance, *patch, *e);
+			else
+				logical_combination<oneOf>::validate_cases(count, validate_case, location, ptr, instance, *patch, *e);
+		} break;
+
+		case opcode::if_then_else: {
+			const auto &c = conditionals_[operand];
+			bool if_succeeded;
+			if (e) {
+				first_error_handler err;
+				run(c.if_, ptr, instance, patch, &err);
+				if_succeeded = !err;
+			} else
+				if_succeeded = run(c.if_, ptr, instance, nullptr, nullptr);
+
+			auto branch = if_succeeded ? c.then_ : c.else_;
+			if (branch != no_block && !run(branch, ptr, instance, patch, e))
+				return false;
+		} break;
+
+		case opcode::null_default:
+			if (patch && instance.is_null())
+				patch->add(nlohmann::json::json_pointer{}, constants_[operand]);
+			break;
+
+		case opcode::expect_null:
+			if (!instance.is_null()) {
+				if (!e)
+					return false;
+				e->error(error_record(error_code::expected_null, ptr, instance, location));
+			}
+			break;
+
+		case opcode::numeric_integer:
+			if (e)
+				integers_[operand].validate(ptr, instance, location, *e);
+			else if (!integers_[operand].is_valid(instance))
+				return false;
+			break;
+
+		case opcode::numeric_float:
+			if (e)
+				floats_[operand].validate(ptr, instance, location, *e);
+			else if (!floats_[operand].is_valid(instance))
+				return false;
+			break;
+
+		case opcode::string_length: {
+			const auto &l = lengths_[operand];
+			string_length length(instance.get_ref<const json::string_t &>());
+			if (l.min_source && length.below(l.min)) {
+				if (!e)
+					return false;
+				e->error(error_record(error_code::min_length, ptr, instance, location, l.min_source));
+			}
+			if (l.max_source && length.above(l.max)) {
+				if (!e)
+					return false;
+				e->error(error_record(error_code::max_length, ptr, instance, location, l.max_source));
+			}
+		} break;
+
+		case opcode::content: {
+			const auto &c = contents_[operand];
+			if (root_->content_check() == nullptr) {
+				if (!e)
+					return false;
+				e->error(error_record(error_code::content_checker_missing, ptr, instance, location, &c.keywords));
+			} else {
+				auto status = root_->content_check().check(c.encoding, c.media_type, instance);
+				if (!status.ok()) {
+					if (!e)
+						return false;
+					const std::string what = status.message();
+					e->error(error_record(error_code::content, ptr, instance, location, &c.keywords, &what));
+				}
+			}
+		} break;
+
+		case opcode::binary_rejected:
+			if (instance.type() == json::value_t::binary) {
+				if (!e)
+					return false;
+				e->error(error_record(error_code::unexpected_binary, ptr, instance, location));
+			}
+			break;
+
+		case opcode::pattern:
+#ifndef NO_STD_REGEX
+			if (instance.type() == json::value_t::string &&
+			    !patterns_[operand].regex->search(instance.get_ref<const json::string_t &>())) {
+				if (!e)
+					return false;
+				e->error(error_record(error_code::pattern, ptr, instance, location, patterns_[operand].source));
+			}
+#endif
+			break;
+
+		case opcode::format:
+			if (instance.type() != json::value_t::string)
+				break;
+
+			if (*formats_[operand].check == nullptr) {
+				if (!e)
+					return false;
+				e->error(error_record(error_code::format_checker_missing, ptr, instance, location, formats_[operand].name));
+			} else {
+				auto status = formats_[operand].check->check(instance.get_ref<const json::string_t &>());
+				if (!status.ok()) {
+					if (!e)
+						return false;
+					const std::string what = status.message();
+					e->error(error_record(error_code::format, ptr, instance, location, formats_[operand].name, &what));
+				}
+			}
+			break;
+
+		case opcode::max_properties:
+			if (instance.size() > sizes_[operand].first) {
+				if (!e)
+					return false;
+				e->error(error_record(error_code::max_properties, ptr, instance, location, &sizes_[operand].second));
+			}
+			break;
+
+		case opcode::min_properties:
+			if (instance.size() < sizes_[operand].first) {
+				if (!e)
+					return false;
+				e->error(error_record(error_code::min_properties, ptr, instance, location, &sizes_[operand].second));
+			}
+			break;
+
+		case opcode::dependency_required:
+			for (auto r = ranges_[operand].begin; r != ranges_[operand].end; ++r)
+				if (instance.find(strings_[r]) == instance.end()) {
+					if (!e)
+						return false;
+					e->error(error_record(error_code::dependency_required, ptr, instance, location, nullptr, &strings_[r]));
+				}
+			break;
+
+		case opcode::object_members: {
+			// the members of an instance and the keys of the schema are both
+			// sorted by name: they are merged instead of looking up each one
+			const bool merge = is_sorted_object<json::object_t>::value;
+			const auto &o = objects_[operand];
+			const auto &members = instance.get_ref<const json::object_t &>();
+			const auto keys = object_keys_.data() + o.keys.begin;
+			const std::size_t key_count = o.keys.end - o.keys.begin;
+
+			// required errors are reported before any member's, so the presence
+			// of keys is determined ahead of validating the members
+			key_set present(key_count);
+			if (o.lookups) {
+				if (merge) {
+					std::size_t k = 0;
+					for (auto m = members.begin(); m != members.end() && k < key_count; ++m) {
+						int order = -1;
+						while (k < key_count && (order = keys[k].name.compare(m->first)) < 0)
+							k++;
+						if (order == 0)
+							present.insert(k++);
+					}
+				} else
+					for (std::size_t k = 0; k < key_count; k++)
+						if (members.find(keys[k].name) != members.end())
+							present.insert(k);
+			}
+
+			for (auto r = o.required.begin; r != o.required.end; ++r)
+				if (!present.contains(key_lists_[r])) {
+					if (!e)
+						return false;
+					e->error(error_record(error_code::required, ptr, instance, location, nullptr, &keys[key_lists_[r]].name));
+				}
+
+			// the blocks validating a member, key is its entry in keys or null -
+			// matched is the scratch for the indices of its matching patternProperties
+			auto resolve = [&](const std::string &name, const object_key *key, std::vector<std::size_t> &matched, member_blocks &resolved) {
+				resolved.blocks.clear();
+				// check if it is in "properties"
+				if (key && key->property != no_block)
+					resolved.blocks.push_back(key->property);
+
+#ifndef NO_STD_REGEX
+				// check all matching patternProperties
+				if (o.patterns) {
+					o.patterns->search(name, matched);
+					for (auto i : matched)
+						resolved.blocks.push_back(block_lists_[o.pattern_properties.begin + i]);
+				}
+#else
+				(void) matched;
+#endif
+
+				// check additionalProperties as a last resort
+				resolved.additional = resolved.blocks.empty() && o.additional_properties != no_block;
+				if (resolved.additional)
+					resolved.blocks.push_back(o.additional_properties);
+
+				if (o.cached_keys && name.size() <= max_cached_key_length)
+					o.cached_keys->insert(name, resolved);
+			};
+
+			auto cached = [&](const std::string &name, member_blocks &resolved) {
+				return o.cached_keys && name.size() <= max_cached_key_length && o.cached_keys->find(name, resolved);
+			};
+
+			auto validate_member = [&](const json::object_t::value_type &m, const member_blocks &resolved,
+			                           json_patch *member_patch, error_handler *member_e) {
+				const auto &name = m.first;
+				const auto &value = m.second;
+
+				if (o.property_names != no_block) {
+					json local;
+					if (!run(o.property_names, ptr, error_store::name_instance(member_e, name, local), member_patch, member_e))
+						return false;
+				}
+
+				instance_path property_ptr(ptr, name);
+
+				if (!resolved.additional) {
+					for (auto member_block : resolved.blocks)
+						if (!run(member_block, property_ptr, value, member_patch, member_e))
+							return false;
+					return true;
+				}
+
+				if (!member_e)
+					return run(o.additional_properties, property_ptr, value, member_patch, nullptr);
+
+				first_error_handler additional_prop_err;
+				run(o.additional_properties, property_ptr, value, member_patch, &additional_prop_err);
+				if (additional_prop_err) {
+					additional_prop_err.hand_over(*member_e);
+					additional_prop_err.first_->visit("", [&](const error_record &cause) {
+						member_e->error(error_record(error_code::additional_properties, ptr, instance, location, nullptr, &name, &cause));
+					});
+				}
+				return true;
+			};
+
+			auto pool = o.members ? root_->parallel_pool(members.size()) : nullptr;
+			if (pool) {
+				std::vector<const json::object_t::value_type *> list;
+				list.reserve(members.size());
+				for (auto &m : members)
+					list.push_back(&m);
+
+				if (!in_parallel(*pool, list.size(), patch, e, [&](std::size_t index, json_patch *member_patch, error_handler *member_e) {
+					    const auto &name = list[index]->first;
+					    member_blocks resolved;
+					    if (!cached(name, resolved)) {
+						    std::vector<std::size_t> matched;
+						    resolve(name, find_key(o.keys, name), matched, resolved);
+					    }
+					    return validate_member(*list[index], resolved, member_patch, member_e);
+				    }))
+					return false;
+			} else {
+				std::vector<std::size_t> matched;
+				member_blocks resolved;
+				std::size_t k = 0;
+				for (auto m = members.begin(); o.members && m != members.end(); ++m) {
+					// the merge moves on for cached members as well
+					const object_key *key = nullptr;
+					if (merge) {
+						int order = -1;
+						while (k < key_count && (order = keys[k].name.compare(m->first)) < 0)
+							k++;
+						if (order == 0)
+							key = &keys[k++];
+					}
+
+					if (!cached(m->first, resolved))
+						resolve(m->first, merge ? key : find_key(o.keys, m->first), matched, resolved);
+
+					if (!validate_member(*m, resolved, patch, e))
+						return false;
+				}
+			}
+
+			// default values of absent properties
+			for (std::size_t i = 0; i < key_count; i++) {
+				if (present.contains(i))
+					continue;
+
+				if (keys[i].reported_default) {
+					basic_error_handler failed;
+					const auto &value = keys[i].reported_default->default_value(ptr, instance, e ? *e : failed);
+					if (failed)
+						return false;
+					if (patch && !value.is_null())
+						patch->add((ptr.to_pointer() / keys[i].name), value);
+				} else if (patch && keys[i].default_value != no_block)
+					patch->add((ptr.to_pointer() / keys[i].name), constants_[keys[i].default_value]);
+			}
+
+			for (std::size_t i = 0; i < key_count; i++)
+				if (keys[i].dependency != no_block && present.contains(i) &&
+				    !run(keys[i].dependency, instance_path(ptr, keys[i].name), instance, patch, e))
+					return false;
+		} break;
+
+		case opcode::max_items:
+			if (instance.size() > sizes_[operand].first) {
+				if (!e)
+					return false;
+				e->error(error_record(error_code::max_items, ptr, instance, location, &sizes_[operand].second));
+			}
+			break;
+
+		case opcode::min_items:
+			if (instance.size() < sizes_[operand].first) {
+				if (!e)
+					return false;
+				e->error(error_record(error_code::min_items, ptr, instance, location, &sizes_[operand].second));
+			}
+			break;
+
+		case opcode::unique_items:
+			if (has_duplicate_items(instance)) {
+				if (!e)
+					return false;
+				e->error(error_record(error_code::unique_items, ptr, instance, location));
+			}
+			break;
+
+		case opcode::items: {
+			if (auto pool = root_->parallel_pool(instance.size())) {
+				const auto &items = instance.get_ref<const json::array_t &>();
+				if (!in_parallel(*pool, items.size(), patch, e, [&](std::size_t index, json_patch *item_patch, error_handler *item_e) {
+					    return run(operand, instance_path(ptr, index), items[index], item_patch, item_e);
+				    }))
+					return false;
+				break;
+			}
+
+			size_t index = 0;
+			for (auto &i : instance) {
+				if (!run(operand, instance_path(ptr, index), i, patch, e))
+					return false;
+				index++;
+			}
+		} break;
+
+		case opcode::tuple_items: {
+			const auto &t = tuples_[operand];
+			size_t index = 0;
+			for (auto &i : instance) {
+				auto item = t.items.begin + index < t.items.end ? block_lists_[t.items.begin + index] : t.additional_items;
+				if (item == no_block)
+					break;
+
+				if (!run(item, instance_path(ptr, index), i, patch, e))
+					return false;
+				index++;
+			}
+		} break;
+
+		case opcode::contains: {
+			bool contained = false;
+			for (auto &item : instance) {
+				if (e) {
+					first_error_handler local_e;
+					run(operand, ptr, item, patch, &local_e);
+					contained = !local_e;
+				} else
+					contained = run(operand, ptr, item, nullptr, nullptr);
+
+				if (contained)
+					break;
+			}
+			if (!contained) {
+				if (!e)
+					return false;
+				e->error(error_record(error_code::contains, ptr, instance, location));
+			}
+		} break;
+		}
+	}
+
+	return true;
+}
+
 } // namespace
 
 namespace
 {
 
-std::shared_ptr<schema> schema::make(json &schema,
-                                     root_schema *root,
-                                     const std::vector<std::string> &keys,
-                                     std::vector<nlohmann::json_uri> uris)
+schema *schema::make(json &schema,
+                     root_schema *root,
+                     const std::vector<std::string> &keys,
+                     std::vector<nlohmann::json_uri> uris)
 {
 	// remove URIs which contain plain name identifiers, as sub-schemas cannot be referenced
 	for (auto uri = uris.begin(); uri != uris.end();)
@@ -1371,11 +3282,13 @@ std::shared_ptr<schema> schema::make(json &schema,
 		for (auto &uri : uris)
 			uri = uri.append(key);
 
-	std::shared_ptr<::schema> sch;
+	::schema *sch = nullptr;
 
 	// boolean schema
-	if (schema.type() == json::value_t::boolean)
-		sch = std::make_shared<boolean>(schema, root);
+	if (schema.type() == json::value_t::boolean) {
+		sch = root->create<boolean>(schema, root);
+		sch->set_location(uris);
+	}
 	else if (schema.type() == json::value_t::object) {
 
 		auto attr = schema.find("$id"); // if $id is present, this schema can be referenced by this ID
@@ -1414,7 +3327,7 @@ std::shared_ptr<schema> schema::make(json &schema,
 				schema.erase(attr);
 			}
 		} else {
-			sch = std::make_shared<type_schema>(schema, root, uris);
+			sch = root->create<type_schema>(schema, root, uris);
 		}
 
 		schema.erase("$schema");
@@ -1442,6 +3355,33 @@ class throwing_error_handler : public error_handler
 	}
 };
 
+// scratch of a task of validate_batch() in all_errors-mode, reused for each of
+// its documents: only the message of the first error is rendered
+class batch_error_handler : public error_handler
+{
+public:
+	batch_result *result = nullptr;
+	json_patch patch;
+
+	void error(const json::json_pointer &ptr, const json &, const std::string &message) override
+	{
+		if (result->errors++ > 0)
+			return;
+		result->valid = false;
+		result->first_error_ptr = ptr;
+		result->first_error = message;
+	}
+
+	void error(const error_record &record) override
+	{
+		if (result->errors++ > 0)
+			return;
+		result->valid = false;
+		result->first_error_ptr = record.ptr();
+		result->first_error = record.message();
+	}
+};
+
 } // namespace
 
 namespace nlohmann
@@ -1449,6 +3389,100 @@ namespace nlohmann
 namespace json_schema
 {
 
+json::json_pointer instance_path::to_pointer() const
+{
+	std::vector<const instance_path *> nodes;
+	for (auto p = this; p->parent_; p = p->parent_)
+		nodes.push_back(p);
+
+	json::json_pointer ptr;
+	for (auto node = nodes.rbegin(); node != nodes.rend(); ++node)
+		if ((*node)->key_)
+			ptr /= *(*node)->key_;
+		else
+			ptr /= (*node)->index_;
+	return ptr;
+}
+
+std::string error_record::message() const
+{
+	std::string message = prefix_ ? *prefix_ : "";
+
+	switch (code_) {
+	case error_code::unresolved_reference:
+		return message + "unresolved or freed schema-reference " + *detail_;
+	case error_code::false_schema:
+		return message + "instance invalid as per false-schema";
+	case error_code::unexpected_type:
+		return message + "unexpected instance type";
+	case error_code::not_in_enum:
+		return message + "instance not found in required enum";
+	case error_code::not_const:
+		return message + "instance not const";
+	case error_code::not_succeeded:
+		return message + "the subschema has succeeded, but it is required to not validate";
+	case error_code::all_of:
+		if (cause_)
+			return message + "at least one subschema has failed, but all of them are required to validate - " + cause_->message();
+		return message + "no subschema has succeeded, but one of them is required to validate. Type: allOf, number of failed subschemas: " + limit_->dump();
+	case error_code::any_of:
+		return message + "no subschema has succeeded, but one of them is required to validate. Type: anyOf, number of failed subschemas: " + limit_->dump();
+	case error_code::one_of:
+		return message + "no subschema has succeeded, but one of them is required to validate. Type: oneOf, number of failed subschemas: " + limit_->dump();
+	case error_code::one_of_multiple:
+		return message + "more than one subschema has succeeded, but exactly one of them is required to validate";
+	case error_code::expected_null:
+		return message + "expected to be null";
+	case error_code::multiple_of:
+		return message + "instance is not a multiple of " + limit_->dump();
+	case error_code::maximum:
+		return message + "instance exceeds maximum of " + limit_->dump();
+	case error_code::exclusive_maximum:
+		return message + "instance exceeds or equals maximum of " + limit_->dump();
+	case error_code::minimum:
+		return message + "instance is below minimum of " + limit_->dump();
+	case error_code::exclusive_minimum:
+		return message + "instance is below or equals minimum of " + limit_->dump();
+	case error_code::min_length:
+		return message + "instance is too short as per minLength:" + limit_->dump();
+	case error_code::max_length:
+		return message + "instance is too long as per maxLength: " + limit_->dump();
+	case error_code::content_checker_missing:
+		return message + "a content checker was not provided but a contentEncoding or contentMediaType for this string have been present: '" +
+		       (*limit_)[0].get<std::string>() + "' '" + (*limit_)[1].get<std::string>() + "'";
+	case error_code::content:
+		return message + "content-checking failed: " + *detail_;
+	case error_code::unexpected_binary:
+		return message + "expected string, but get binary data";
+	case error_code::pattern:
+		return message + "instance does not match regex pattern: " + limit_->get<std::string>();
+	case error_code::format_checker_missing:
+		return message + "a format checker was not provided but a format keyword for this string is present: " + limit_->get<std::string>();
+	case error_code::format:
+		return message + "format-checking failed: " + *detail_;
+	case error_code::max_properties:
+		return message + "too many properties";
+	case error_code::min_properties:
+		return message + "too few properties";
+	case error_code::required:
+		return message + "required property '" + *detail_ + "' not found in object";
+	case error_code::additional_properties:
+		return message + "validation failed for additional property '" + *detail_ + "': " + cause_->message();
+	case error_code::dependency_required:
+		return message + "required property '" + *detail_ + "' not found in object as a dependency";
+	case error_code::max_items:
+		return message + "array has too many items";
+	case error_code::min_items:
+		return message + "array has too few items";
+	case error_code::unique_items:
+		return message + "items have to be unique for this array";
+	case error_code::contains:
+		return message + "array does not contain required element as per 'contains'";
+	}
+
+	return message;
+}
+
 json_validator::json_validator(schema_loader loader,
                                format_checker format,
                                content_checker content)
@@ -1487,6 +3521,36 @@ json_validator::json_validator(json_validator &&) = default;
 json_validator::~json_validator() = default;
 json_validator &json_validator::operator=(json_validator &&) = default;
 
+void json_validator::add_format(const std::string &format, format_value_checker check)
+{
+	root_->add_format(format, std::move(check));
+}
+
+void json_validator::cache_format(const std::string &format)
+{
+	root_->cache_format(format);
+}
+
+void json_validator::set_format_cache_size(std::size_t entries)
+{
+	root_->set_format_cache_size(entries);
+}
+
+void json_validator::cache_object_keys(std::size_t entries)
+{
+	root_->cache_object_keys(entries);
+}
+
+format_cache_stats json_validator::cache_stats(const std::string &format) const
+{
+	return root_->cache_stats(format);
+}
+
+void json_validator::set_parallel(std::size_t threshold, std::shared_ptr<thread_pool> pool)
+{
+	root_->set_parallel(threshold, std::move(pool));
+}
+
 void json_validator::set_root_schema(const json &schema)
 {
 	root_->set_root_schema(schema);
@@ -1505,11 +3569,58 @@ json json_validator::validate(const json &instance) const
 
 json json_validator::validate(const json &instance, error_handler &err, const json_uri &initial_uri) const
 {
-	json::json_pointer ptr;
 	json_patch patch;
-	root_->validate(ptr, instance, patch, err, initial_uri);
+	root_->validate(instance, patch, err, initial_uri);
 	return patch;
 }
 
+bool json_validator::is_valid(const json &instance) const
+{
+	return root_->validate(instance);
+}
+
+void json_validator::validate_batch(const json *documents, std::size_t count, batch_result *results,
+                                    batch_mode mode, thread_pool *pool) const
+{
+	std::shared_ptr<thread_pool> own_pool;
+	if (!pool)
+		pool = root_->pool();
+	if (!pool && count > 1) {
+		own_pool = root_->own_pool();
+		pool = own_pool.get();
+	}
+
+	// documents are validated in chunks, a task each, to balance the load
+	// while reusing the scratch of a task
+	const auto chunks = pool ? std::min(count, (pool->size() + 1) * 4) : count;
+	auto validate_chunk = [&](std::size_t c) {
+		batch_error_handler scratch;
+		for (auto i = count * c / chunks; i < count * (c + 1) / chunks; ++i) {
+			results[i] = batch_result();
+			if (mode == batch_mode::fail_fast) {
+				results[i].valid = root_->validate(documents[i]);
+				results[i].errors = results[i].valid ? 0 : 1;
+			} else {
+				scratch.result = &results[i];
+				scratch.patch.get_json().clear();
+				root_->validate(documents[i], scratch.patch, scratch, json_uri("#"));
+			}
+		}
+	};
+
+	if (pool)
+		pool->parallel_for(chunks, validate_chunk);
+	else if (chunks)
+		validate_chunk(0);
+}
+
+std::vector<batch_result> json_validator::validate_batch(const std::vector<json> &documents,
+                                                         batch_mode mode, thread_pool *pool) const
+{
+	std::vector<batch_result> results(documents.size());
+	validate_batch(documents.data(), documents.size(), results.data(), mode, pool);
+	return results;
+}
+
 } // namespace json_schema
 } // namespace nlohmann
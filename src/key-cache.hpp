@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace nlohmann
+{
+namespace json_schema
+{
+
+// Bounded thread-safe map of strings to values, split into shards each with
+// its own lock. A full shard replaces the entry chosen by CLOCK - an
+// approximation of least-recently-used, as in the format_cache.
+template <typename Value>
+class key_cache
+{
+	static const std::size_t shard_count = 8;
+
+	struct entry {
+		std::string key;
+		Value value;
+		bool referenced = false;
+	};
+
+	struct shard {
+		std::mutex mutex;
+		std::unordered_map<std::string, std::size_t> index; // into entries
+		std::vector<entry> entries;
+		std::size_t hand = 0; // of CLOCK
+	};
+
+	std::array<shard, shard_count> shards_;
+	std::size_t shard_capacity_;
+
+	shard &shard_of(const std::string &key) { return shards_[std::hash<std::string>()(key) % shard_count]; }
+
+public:
+	explicit key_cache(std::size_t capacity)
+	    : shard_capacity_((capacity + shard_count - 1) / shard_count) {}
+
+	key_cache(const key_cache &) = delete;
+	key_cache &operator=(const key_cache &) = delete;
+
+	// copies the value of key, if present
+	bool find(const std::string &key, Value &value)
+	{
+		auto &s = shard_of(key);
+		std::lock_guard<std::mutex> lock(s.mutex);
+		auto i = s.index.find(key);
+		if (i == s.index.end())
+			return false;
+
+		auto &e = s.entries[i->second];
+		e.referenced = true;
+		value = e.value;
+		return true;
+	}
+
+	void insert(const std::string &key, const Value &value)
+	{
+		if (shard_capacity_ == 0)
+			return;
+
+		auto &s = shard_of(key);
+		std::lock_guard<std::mutex> lock(s.mutex);
+		auto i = s.index.find(key);
+		if (i != s.index.end()) { // inserted by another thread meanwhile
+			s.entries[i->second].value = value;
+			return;
+		}
+
+		if (s.entries.size() < shard_capacity_) {
+			s.index.emplace(key, s.entries.size());
+			s.entries.push_back({key, value, false});
+			return;
+		}
+
+		// entries referenced since the hand passed them get another round
+		while (s.entries[s.hand].referenced) {
+			s.entries[s.hand].referenced = false;
+			s.hand = (s.hand + 1) % s.entries.size();
+		}
+
+		auto &victim = s.entries[s.hand];
+		s.index.erase(victim.key);
+		s.index.emplace(key, s.hand);
+		victim.key = key;
+		victim.value = value;
+		s.hand = (s.hand + 1) % s.entries.size();
+	}
+};
+
+} // namespace json_schema
+} // namespace nlohmann
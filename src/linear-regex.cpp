@@ -0,0 +1,1179 @@
+#include "linear-regex.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace nlohmann
+{
+namespace json_schema
+{
+
+namespace
+{
+
+typedef std::uint32_t code_point;
+
+// invalid UTF-8 bytes are matched as code points of their own beyond Unicode
+const code_point invalid_byte = 0x110000;
+const code_point code_point_end = invalid_byte + 0x100;
+
+const unsigned unbounded = ~0u;
+
+// limits of what is compiled, beyond them the fallback is used
+const std::size_t max_instructions = 10000;
+const unsigned max_repetitions = 1000;
+const unsigned max_nesting = 256;
+
+// the DFA of one pattern is bounded to this many states and size of transition tables
+const std::size_t dfa_states = 4096;
+const std::size_t dfa_memory = 1024 * 1024;
+
+code_point decode(const unsigned char *&p, const unsigned char *end)
+{
+	code_point c = *p;
+	if (c < 0x80) {
+		++p;
+		return c;
+	}
+
+	std::ptrdiff_t length;
+	code_point min;
+	if ((c & 0xe0) == 0xc0) {
+		length = 2;
+		c &= 0x1f;
+		min = 0x80;
+	} else if ((c & 0xf0) == 0xe0) {
+		length = 3;
+		c &= 0x0f;
+		min = 0x800;
+	} else if ((c & 0xf8) == 0xf0) {
+		length = 4;
+		c &= 0x07;
+		min = 0x10000;
+	} else
+		return invalid_byte + *p++;
+
+	if (end - p < length)
+		return invalid_byte + *p++;
+
+	for (std::ptrdiff_t i = 1; i < length; i++) {
+		if ((p[i] & 0xc0) != 0x80)
+			return invalid_byte + *p++;
+		c = (c << 6) | (p[i] & 0x3f);
+	}
+
+	if (c < min || c > 0x10ffff || (c >= 0xd800 && c <= 0xdfff))
+		return invalid_byte + *p++;
+
+	p += length;
+	return c;
+}
+
+bool is_word(code_point c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+struct code_range {
+	code_point first, last; // inclusive
+
+	bool operator<(const code_range &other) const { return first < other.first; }
+};
+
+typedef std::vector<code_range> char_class;
+
+void normalize(char_class &cls)
+{
+	std::sort(cls.begin(), cls.end());
+
+	char_class merged;
+	for (auto &r : cls)
+		if (!merged.empty() && r.first <= merged.back().last + 1)
+			merged.back().last = std::max(merged.back().last, r.last);
+		else
+			merged.push_back(r);
+	cls.swap(merged);
+}
+
+// expects a normalized class
+char_class complement(const char_class &cls)
+{
+	char_class result;
+	code_point next = 0;
+	for (auto &r : cls) {
+		if (r.first > next)
+			result.push_back({next, r.first - 1});
+		next = r.last + 1;
+	}
+	if (next < code_point_end)
+		result.push_back({next, code_point_end - 1});
+	return result;
+}
+
+bool contains(const char_class &cls, code_point c)
+{
+	auto r = std::upper_bound(cls.begin(), cls.end(), code_range{c, c});
+	return r != cls.begin() && c <= (r - 1)->last;
+}
+
+const char_class &digit_class()
+{
+	static const char_class digits{{'0', '9'}};
+	return digits;
+}
+
+const char_class &word_class()
+{
+	static const char_class word{{'0', '9'}, {'A', 'Z'}, {'_', '_'}, {'a', 'z'}};
+	return word;
+}
+
+const char_class &space_class()
+{
+	static const char_class space{{0x09, 0x0d}, {0x20, 0x20}, {0xa0, 0xa0}, {0x1680, 0x1680}, {0x2000, 0x200a}, {0x2028, 0x2029}, {0x202f, 0x202f}, {0x205f, 0x205f}, {0x3000, 0x3000}, {0xfeff, 0xfeff}};
+	return space;
+}
+
+const char_class &dot_class()
+{
+	static const char_class dot = complement({{0x0a, 0x0a}, {0x0d, 0x0d}, {0x2028, 0x2029}});
+	return dot;
+}
+
+struct node {
+	enum kind_t {
+		match_class,
+		sequence,
+		alternation,
+		repetition,
+		line_begin,
+		line_end,
+		word_boundary,
+		not_word_boundary,
+	};
+
+	kind_t kind;
+	std::uint32_t class_index = 0; // match_class
+	unsigned min = 0, max = 0;     // repetition of the single child
+	std::vector<node> children;
+
+	node(kind_t k)
+	    : kind(k) {}
+};
+
+struct instruction {
+	enum op_t : std::uint8_t {
+		match_class, // x: index of the class
+		split,       // x and y
+		jump,        // x
+		match, // x: index of the pattern
+		line_begin,
+		line_end,
+		word_boundary,
+		not_word_boundary,
+	};
+
+	op_t op;
+	std::uint32_t x, y;
+};
+
+// recursive descent parser of the pattern's code points into nodes
+class parser
+{
+	std::vector<code_point> pattern_;
+	std::size_t pos_ = 0;
+	unsigned depth_ = 0;
+
+	std::vector<char_class> &classes_;
+	bool &word_boundaries_;
+
+	[[noreturn]] static void unsupported(const std::string &what)
+	{
+		throw regex_unsupported("regex: " + what);
+	}
+
+	bool at_end() const { return pos_ == pattern_.size(); }
+	code_point peek(std::size_t ahead = 0) const { return pos_ + ahead < pattern_.size() ? pattern_[pos_ + ahead] : code_point_end; }
+	code_point next()
+	{
+		if (at_end())
+			unsupported("unexpected end of pattern");
+		return pattern_[pos_++];
+	}
+
+	node single(const char_class &cls)
+	{
+		node n(node::match_class);
+		n.class_index = static_cast<std::uint32_t>(classes_.size());
+		classes_.push_back(cls);
+		return n;
+	}
+
+	static bool is_hex(code_point c)
+	{
+		return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+	}
+
+	code_point hex(unsigned digits)
+	{
+		code_point value = 0;
+		for (unsigned i = 0; i < digits; i++) {
+			auto c = next();
+			if (!is_hex(c))
+				unsupported("invalid hexadecimal escape");
+			value = value * 16 + (c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+		}
+		return value;
+	}
+
+	// escape after a backslash, either a character or a class
+	bool escape(code_point &c, char_class &cls, bool in_class)
+	{
+		c = next();
+		switch (c) {
+		case 'd':
+			cls = digit_class();
+			return false;
+		case 'D':
+			cls = complement(digit_class());
+			return false;
+		case 'w':
+			cls = word_class();
+			return false;
+		case 'W':
+			cls = complement(word_class());
+			return false;
+		case 's':
+			cls = space_class();
+			return false;
+		case 'S':
+			cls = complement(space_class());
+			return false;
+
+		case 't':
+			c = 0x09;
+			return true;
+		case 'n':
+			c = 0x0a;
+			return true;
+		case 'v':
+			c = 0x0b;
+			return true;
+		case 'f':
+			c = 0x0c;
+			return true;
+		case 'r':
+			c = 0x0d;
+			return true;
+
+		case '0':
+			if (peek() >= '0' && peek() <= '9')
+				unsupported("octal escape");
+			c = 0;
+			return true;
+
+		case 'c': {
+			auto letter = next();
+			if (!((letter >= 'a' && letter <= 'z') || (letter >= 'A' && letter <= 'Z')))
+				unsupported("invalid control escape");
+			c = letter % 32;
+			return true;
+		}
+
+		case 'x':
+			c = hex(2);
+			return true;
+
+		case 'u':
+			if (peek() == '{')
+				unsupported("code point escape");
+			c = hex(4);
+			// surrogate pairs are matched as the code point they encode
+			if (c >= 0xd800 && c <= 0xdbff && peek() == '\\' && peek(1) == 'u') {
+				auto saved = pos_;
+				pos_ += 2;
+				bool low = true;
+				for (std::size_t i = 0; i < 4; i++)
+					low = low && is_hex(peek(i));
+				code_point second = low ? hex(4) : 0;
+				if (second >= 0xdc00 && second <= 0xdfff)
+					c = 0x10000 + ((c - 0xd800) << 10) + (second - 0xdc00);
+				else
+					pos_ = saved;
+			}
+			return true;
+
+		case 'b':
+			if (!in_class)
+				break;
+			c = 0x08;
+			return true;
+
+		case '-':
+			if (!in_class)
+				break;
+			return true;
+
+		case '^':
+		case '$':
+		case '\\':
+		case '.':
+		case '*':
+		case '+':
+		case '?':
+		case '(':
+		case ')':
+		case '[':
+		case ']':
+		case '{':
+		case '}':
+		case '|':
+		case '/':
+			return true;
+		}
+
+		unsupported("escape");
+	}
+
+	node bracket_class()
+	{
+		bool negate = false;
+		if (peek() == '^') {
+			negate = true;
+			pos_++;
+		}
+		if (peek() == ']')
+			unsupported("empty class");
+
+		char_class cls;
+		while (peek() != ']') {
+			code_point first, last;
+			char_class escaped;
+
+			bool is_char = true;
+			first = next();
+			if (first == '\\')
+				is_char = escape(first, escaped, true);
+
+			if (!is_char) {
+				cls.insert(cls.end(), escaped.begin(), escaped.end());
+				continue;
+			}
+
+			last = first;
+			if (peek() == '-' && peek(1) != ']' && peek(1) != code_point_end) {
+				pos_++;
+				last = next();
+				if (last == '\\' && !escape(last, escaped, true))
+					unsupported("class in range");
+				if (last < first)
+					unsupported("invalid range");
+			}
+			cls.push_back({first, last});
+		}
+		pos_++; // ]
+
+		normalize(cls);
+		return single(negate ? complement(cls) : cls);
+	}
+
+	void quantifier(unsigned &min, unsigned &max)
+	{
+		switch (peek()) {
+		case '*':
+			min = 0;
+			max = unbounded;
+			break;
+		case '+':
+			min = 1;
+			max = unbounded;
+			break;
+		case '?':
+			min = 0;
+			max = 1;
+			break;
+		case '{': {
+			pos_++;
+			auto number = [this]() {
+				if (!(peek() >= '0' && peek() <= '9'))
+					unsupported("invalid repetition");
+				unsigned value = 0;
+				while (peek() >= '0' && peek() <= '9') {
+					value = value * 10 + (next() - '0');
+					if (value > max_repetitions)
+						unsupported("repetition count too large");
+				}
+				return value;
+			};
+			min = max = number();
+			if (peek() == ',') {
+				pos_++;
+				max = peek() == '}' ? unbounded : number();
+			}
+			if (peek() != '}' || min > max)
+				unsupported("invalid repetition");
+		} break;
+		default:
+			return;
+		}
+		pos_++;
+
+		if (peek() == '?') // lazy, the same for searching
+			pos_++;
+	}
+
+	bool is_quantifier(code_point c) const { return c == '*' || c == '+' || c == '?' || c == '{'; }
+
+	node term()
+	{
+		auto c = next();
+		switch (c) {
+		case '^':
+		case '$': {
+			if (is_quantifier(peek()))
+				unsupported("quantified assertion");
+			return node(c == '^' ? node::line_begin : node::line_end);
+		}
+
+		case '\\':
+			if (peek() == 'b' || peek() == 'B') {
+				word_boundaries_ = true;
+				auto kind = next() == 'b' ? node::word_boundary : node::not_word_boundary;
+				if (is_quantifier(peek()))
+					unsupported("quantified assertion");
+				return node(kind);
+			}
+			break;
+
+		case '*':
+		case '+':
+		case '?':
+		case '{':
+			unsupported("nothing to repeat");
+		case '}':
+		case ']':
+			unsupported("unescaped bracket");
+		}
+
+		node atom(node::sequence);
+		if (c == '(') {
+			if (peek() == '?') {
+				if (peek(1) != ':')
+					unsupported("lookaround or named group");
+				pos_ += 2;
+			}
+			if (++depth_ > max_nesting)
+				unsupported("nesting too deep");
+			atom = disjunction();
+			depth_--;
+			if (next() != ')')
+				unsupported("missing )");
+		} else if (c == '.')
+			atom = single(dot_class());
+		else if (c == '[')
+			atom = bracket_class();
+		else if (c == '\\') {
+			code_point e;
+			char_class cls;
+			atom = escape(e, cls, false) ? single({{e, e}}) : single(cls);
+		} else
+			atom = single({{c, c}});
+
+		unsigned min, max;
+		if (!is_quantifier(peek()))
+			return atom;
+
+		quantifier(min, max);
+		node n(node::repetition);
+		n.min = min;
+		n.max = max;
+		n.children.push_back(std::move(atom));
+		return n;
+	}
+
+	node alternative()
+	{
+		node n(node::sequence);
+		while (!at_end() && peek() != '|' && peek() != ')')
+			n.children.push_back(term());
+		return n;
+	}
+
+	node disjunction()
+	{
+		node first = alternative();
+		if (peek() != '|')
+			return first;
+
+		node n(node::alternation);
+		n.children.push_back(std::move(first));
+		while (peek() == '|') {
+			pos_++;
+			n.children.push_back(alternative());
+		}
+		return n;
+	}
+
+public:
+	parser(const std::string &pattern, std::vector<char_class> &classes, bool &word_boundaries)
+	    : classes_(classes), word_boundaries_(word_boundaries)
+	{
+		auto p = reinterpret_cast<const unsigned char *>(pattern.data());
+		auto end = p + pattern.size();
+		while (p != end)
+			pattern_.push_back(decode(p, end));
+	}
+
+	node parse()
+	{
+		node n = disjunction();
+		if (!at_end())
+			unsupported("unmatched )");
+		return n;
+	}
+};
+
+void compile(const node &n, std::vector<instruction> &code)
+{
+	if (code.size() > max_instructions)
+		throw regex_unsupported("regex: pattern too large");
+
+	switch (n.kind) {
+	case node::match_class:
+		code.push_back({instruction::match_class, n.class_index, 0});
+		break;
+
+	case node::sequence:
+		for (auto &child : n.children)
+			compile(child, code);
+		break;
+
+	case node::alternation: {
+		std::vector<std::size_t> jumps;
+		for (std::size_t i = 0; i < n.children.size(); i++) {
+			if (i + 1 == n.children.size()) {
+				compile(n.children[i], code);
+				break;
+			}
+			auto split = code.size();
+			code.push_back({instruction::split, static_cast<std::uint32_t>(split + 1), 0});
+			compile(n.children[i], code);
+			jumps.push_back(code.size());
+			code.push_back({instruction::jump, 0, 0});
+			code[split].y = static_cast<std::uint32_t>(code.size());
+		}
+		for (auto j : jumps)
+			code[j].x = static_cast<std::uint32_t>(code.size());
+	} break;
+
+	case node::repetition: {
+		for (unsigned i = 0; i < n.min; i++)
+			compile(n.children[0], code);
+
+		if (n.max == unbounded) {
+			auto loop = code.size();
+			code.push_back({instruction::split, static_cast<std::uint32_t>(loop + 1), 0});
+			compile(n.children[0], code);
+			code.push_back({instruction::jump, static_cast<std::uint32_t>(loop), 0});
+			code[loop].y = static_cast<std::uint32_t>(code.size());
+		} else {
+			std::vector<std::size_t> splits;
+			for (unsigned i = n.min; i < n.max; i++) {
+				splits.push_back(code.size());
+				code.push_back({instruction::split, static_cast<std::uint32_t>(code.size() + 1), 0});
+				compile(n.children[0], code);
+			}
+			for (auto s : splits)
+				code[s].y = static_cast<std::uint32_t>(code.size());
+		}
+	} break;
+
+	case node::line_begin:
+		code.push_back({instruction::line_begin, 0, 0});
+		break;
+	case node::line_end:
+		code.push_back({instruction::line_end, 0, 0});
+		break;
+	case node::word_boundary:
+		code.push_back({instruction::word_boundary, 0, 0});
+		break;
+	case node::not_word_boundary:
+		code.push_back({instruction::not_word_boundary, 0, 0});
+		break;
+	}
+}
+
+// what is known about the position at which threads are added
+struct context {
+	bool at_begin;
+	bool at_end;
+	bool prev_word, next_word;
+};
+
+// instructions reached at one position, each at most once
+class thread_list
+{
+	std::vector<std::uint32_t> marks_;
+	std::uint32_t generation_ = 1;
+
+public:
+	std::vector<std::uint32_t> pcs; // match_class-, match- and pending line_end-instructions
+	bool matched = false;
+
+	thread_list(std::size_t size)
+	    : marks_(size, 0) {}
+
+	void clear()
+	{
+		pcs.clear();
+		matched = false;
+		if (++generation_ == 0) {
+			std::fill(marks_.begin(), marks_.end(), 0);
+			generation_ = 1;
+		}
+	}
+
+	bool mark(std::uint32_t pc)
+	{
+		if (marks_[pc] == generation_)
+			return false;
+		marks_[pc] = generation_;
+		return true;
+	}
+};
+
+// patterns which matched so far, without allocating for up to 64 patterns
+class match_set
+{
+	std::uint64_t small_ = 0;
+	std::vector<bool> large_;
+	std::size_t count_ = 0;
+	std::size_t wanted_;
+
+public:
+	// scanning stops once wanted patterns matched
+	match_set(std::size_t patterns, std::size_t wanted)
+	    : wanted_(wanted)
+	{
+		if (patterns > 64)
+			large_.resize(patterns);
+	}
+
+	void insert(std::uint32_t pattern)
+	{
+		if (large_.empty()) {
+			if (!(small_ >> pattern & 1)) {
+				small_ |= std::uint64_t(1) << pattern;
+				count_++;
+			}
+		} else if (!large_[pattern]) {
+			large_[pattern] = true;
+			count_++;
+		}
+	}
+
+	void insert(const std::vector<std::uint32_t> &patterns)
+	{
+		for (auto pattern : patterns)
+			insert(pattern);
+	}
+
+	bool complete() const { return count_ >= wanted_; }
+	bool empty() const { return count_ == 0; }
+
+	void indices(std::vector<std::size_t> &result) const
+	{
+		result.clear();
+		if (large_.empty()) {
+			for (std::size_t i = 0; i < 64; i++)
+				if (small_ >> i & 1)
+					result.push_back(i);
+		} else
+			for (std::size_t i = 0; i < large_.size(); i++)
+				if (large_[i])
+					result.push_back(i);
+	}
+};
+
+struct dfa_state {
+	std::vector<std::uint32_t> threads;     // sorted
+	std::vector<std::uint32_t> matches;     // patterns matching at this state
+	std::vector<std::uint32_t> end_matches; // patterns matching if the subject ends here
+	std::unique_ptr<std::atomic<const dfa_state *>[]> next; // per equivalence class, null if not yet known
+};
+
+void encode(code_point c, std::string &out)
+{
+	if (c < 0x80)
+		out += static_cast<char>(c);
+	else if (c < 0x800) {
+		out += static_cast<char>(0xc0 | c >> 6);
+		out += static_cast<char>(0x80 | (c & 0x3f));
+	} else if (c < 0x10000) {
+		out += static_cast<char>(0xe0 | c >> 12);
+		out += static_cast<char>(0x80 | (c >> 6 & 0x3f));
+		out += static_cast<char>(0x80 | (c & 0x3f));
+	} else {
+		out += static_cast<char>(0xf0 | c >> 18);
+		out += static_cast<char>(0x80 | (c >> 12 & 0x3f));
+		out += static_cast<char>(0x80 | (c >> 6 & 0x3f));
+		out += static_cast<char>(0x80 | (c & 0x3f));
+	}
+}
+
+// dedicated scanner of a pattern of trivial shape, checked without the automaton
+struct specialization {
+	enum kind_t {
+		none,
+		contains,  // literal
+		prefix,    // ^literal
+		suffix,    // literal$
+		equals,    // ^literal$
+		class_run, // ^[class]{min,max}$ of ASCII characters
+	};
+
+	kind_t kind = none;
+	std::string literal;
+	std::array<bool, 0x100> bytes; // class_run
+	std::size_t min = 0, max = 0;
+
+	bool search(const std::string &subject) const
+	{
+		switch (kind) {
+		case contains:
+			return subject.find(literal) != std::string::npos;
+		case prefix:
+			return subject.size() >= literal.size() && subject.compare(0, literal.size(), literal) == 0;
+		case suffix:
+			return subject.size() >= literal.size() && subject.compare(subject.size() - literal.size(), literal.size(), literal) == 0;
+		case equals:
+			return subject == literal;
+		case class_run:
+			if (subject.size() < min || subject.size() > max)
+				return false;
+			for (unsigned char c : subject)
+				if (!bytes[c])
+					return false;
+			return true;
+		case none:
+			break;
+		}
+		return false;
+	}
+};
+
+void flatten(const node &n, std::vector<const node *> &items)
+{
+	if (n.kind == node::sequence)
+		for (auto &child : n.children)
+			flatten(child, items);
+	else
+		items.push_back(&n);
+}
+
+// the code point of a class matching exactly one which is valid UTF-8 - only then
+// comparing bytes is the same as comparing decoded code points
+bool single_code_point(const node &n, const std::vector<char_class> &classes, code_point &c)
+{
+	if (n.kind != node::match_class)
+		return false;
+	auto &cls = classes[n.class_index];
+	if (cls.size() != 1 || cls[0].first != cls[0].last)
+		return false;
+	c = cls[0].first;
+	return c < invalid_byte && !(c >= 0xd800 && c <= 0xdfff);
+}
+
+specialization specialize(const node &root, const std::vector<char_class> &classes)
+{
+	specialization s;
+
+	std::vector<const node *> items;
+	flatten(root, items);
+
+	bool begin = !items.empty() && items.front()->kind == node::line_begin;
+	if (begin)
+		items.erase(items.begin());
+	bool end = !items.empty() && items.back()->kind == node::line_end;
+	if (end)
+		items.pop_back();
+
+	std::string literal;
+	bool is_literal = true;
+	for (auto item : items) {
+		code_point c;
+		if (!single_code_point(*item, classes, c)) {
+			is_literal = false;
+			break;
+		}
+		encode(c, literal);
+	}
+	if (is_literal) {
+		s.kind = begin ? (end ? specialization::equals : specialization::prefix)
+		               : (end ? specialization::suffix : specialization::contains);
+		s.literal = std::move(literal);
+		return s;
+	}
+
+	if (!begin || !end || items.size() != 1)
+		return s;
+
+	const node *run = items[0];
+	std::size_t min = 1, max = 1;
+	if (run->kind == node::repetition) {
+		min = run->min;
+		max = run->max == unbounded ? std::string::npos : run->max;
+		std::vector<const node *> repeated;
+		flatten(run->children[0], repeated);
+		if (repeated.size() != 1)
+			return s;
+		run = repeated[0];
+	}
+	if (run->kind != node::match_class)
+		return s;
+
+	// ASCII characters are one byte each, so the length is the number of bytes
+	auto &cls = classes[run->class_index];
+	s.bytes.fill(false);
+	for (auto &r : cls) {
+		if (r.last >= 0x80)
+			return s;
+		for (code_point c = r.first; c <= r.last; c++)
+			s.bytes[c] = true;
+	}
+	s.kind = specialization::class_run;
+	s.min = min;
+	s.max = max;
+	return s;
+}
+
+} // namespace
+
+struct linear_regex::program {
+	std::vector<instruction> code;
+	std::vector<char_class> classes;
+	std::size_t patterns = 0;
+	bool word_boundaries = false;
+	specialization special; // of a single pattern
+
+	// code points which no class tells apart share an equivalence class,
+	// boundaries holds the first code point of each
+	std::vector<code_point> boundaries;
+	std::array<std::uint32_t, 0x80> ascii;
+
+	std::once_flag prepared; // the DFA is set up on the first scan
+	std::mutex mutex;        // guards adding states
+	std::map<std::vector<std::uint32_t>, std::unique_ptr<dfa_state>> states;
+	std::size_t max_states;
+	std::unique_ptr<dfa_state> start;
+
+	program(const std::vector<std::string> &sources)
+	    : patterns(sources.size())
+	{
+		// a split-chain to all patterns, each ending with its own match
+		for (std::size_t i = 0; i < sources.size(); i++) {
+			auto split = code.size();
+			if (i + 1 < sources.size())
+				code.push_back({instruction::split, static_cast<std::uint32_t>(split + 1), 0});
+
+			node root = parser(sources[i], classes, word_boundaries).parse();
+			if (sources.size() == 1)
+				special = specialize(root, classes);
+			compile(root, code);
+			code.push_back({instruction::match, static_cast<std::uint32_t>(i), 0});
+
+			if (i + 1 < sources.size())
+				code[split].y = static_cast<std::uint32_t>(code.size());
+		}
+	}
+
+	void prepare()
+	{
+		boundaries.push_back(0);
+		for (auto &cls : classes)
+			for (auto &r : cls) {
+				boundaries.push_back(r.first);
+				if (r.last + 1 < code_point_end)
+					boundaries.push_back(r.last + 1);
+			}
+		std::sort(boundaries.begin(), boundaries.end());
+		boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+		for (code_point c = 0; c < 0x80; c++)
+			ascii[c] = static_cast<std::uint32_t>(std::upper_bound(boundaries.begin(), boundaries.end(), c) - boundaries.begin() - 1);
+
+		max_states = std::max<std::size_t>(16, std::min(dfa_states, dfa_memory / (boundaries.size() * sizeof(void *))));
+
+		thread_list threads(code.size());
+		std::vector<std::uint32_t> stack;
+		closure(0, {true, false, false, false}, threads, stack);
+		start = make_state(threads, true);
+	}
+
+	std::uint32_t class_of(code_point c) const
+	{
+		if (c < 0x80)
+			return ascii[c];
+		return static_cast<std::uint32_t>(std::upper_bound(boundaries.begin(), boundaries.end(), c) - boundaries.begin() - 1);
+	}
+
+	void closure(std::uint32_t pc, const context &ctx, thread_list &threads, std::vector<std::uint32_t> &stack) const
+	{
+		stack.push_back(pc);
+		while (!stack.empty()) {
+			pc = stack.back();
+			stack.pop_back();
+			if (!threads.mark(pc))
+				continue;
+
+			const auto &in = code[pc];
+			switch (in.op) {
+			case instruction::match:
+				threads.matched = true;
+				threads.pcs.push_back(pc);
+				break;
+			case instruction::match_class:
+				threads.pcs.push_back(pc);
+				break;
+			case instruction::split:
+				stack.push_back(in.y);
+				stack.push_back(in.x);
+				break;
+			case instruction::jump:
+				stack.push_back(in.x);
+				break;
+			case instruction::line_begin:
+				if (ctx.at_begin)
+					stack.push_back(pc + 1);
+				break;
+			case instruction::line_end:
+				if (ctx.at_end)
+					stack.push_back(pc + 1);
+				else // the end may be reached right after
+					threads.pcs.push_back(pc);
+				break;
+			case instruction::word_boundary:
+				if (ctx.prev_word != ctx.next_word)
+					stack.push_back(pc + 1);
+				break;
+			case instruction::not_word_boundary:
+				if (ctx.prev_word == ctx.next_word)
+					stack.push_back(pc + 1);
+				break;
+			}
+		}
+	}
+
+	// threads reached after consuming c, including new ones starting at pc 0
+	void step(const std::vector<std::uint32_t> &current, code_point c, const context &ctx, thread_list &next, std::vector<std::uint32_t> &stack) const
+	{
+		next.clear();
+		for (auto pc : current)
+			if (code[pc].op == instruction::match_class && contains(classes[code[pc].x], c))
+				closure(pc + 1, ctx, next, stack);
+		closure(0, ctx, next, stack);
+	}
+
+	void matches(const std::vector<std::uint32_t> &threads, std::vector<std::uint32_t> &result) const
+	{
+		for (auto pc : threads)
+			if (code[pc].op == instruction::match)
+				result.push_back(code[pc].x);
+	}
+
+	// patterns of the threads matching at the end of the subject
+	void matches_at_end(const std::vector<std::uint32_t> &threads, context ctx, std::vector<std::uint32_t> &result) const
+	{
+		ctx.at_end = true;
+		ctx.next_word = false;
+
+		matches(threads, result);
+
+		thread_list end(code.size());
+		std::vector<std::uint32_t> stack;
+		for (auto pc : threads)
+			if (code[pc].op == instruction::line_end) {
+				end.clear();
+				closure(pc + 1, ctx, end, stack);
+				matches(end.pcs, result);
+			}
+	}
+
+	std::unique_ptr<dfa_state> make_state(const thread_list &threads, bool at_begin) const
+	{
+		std::unique_ptr<dfa_state> s(new dfa_state);
+		s->threads = threads.pcs;
+		std::sort(s->threads.begin(), s->threads.end());
+
+		matches(s->threads, s->matches);
+		matches_at_end(s->threads, {at_begin, false, false, false}, s->end_matches);
+		std::sort(s->end_matches.begin(), s->end_matches.end());
+		s->end_matches.erase(std::unique(s->end_matches.begin(), s->end_matches.end()), s->end_matches.end());
+
+		s->next.reset(new std::atomic<const dfa_state *>[boundaries.size()]);
+		for (std::size_t i = 0; i < boundaries.size(); i++)
+			s->next[i].store(nullptr, std::memory_order_relaxed);
+		return s;
+	}
+
+	// the DFA-state following s for an equivalence class, null if there are already too many states
+	const dfa_state *transition(const dfa_state &s, std::uint32_t cls)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto known = s.next[cls].load(std::memory_order_acquire);
+		if (known)
+			return known;
+
+		thread_list next(code.size());
+		std::vector<std::uint32_t> stack;
+		step(s.threads, boundaries[cls], {false, false, false, false}, next, stack);
+
+		auto key = next.pcs;
+		std::sort(key.begin(), key.end());
+
+		auto found = states.find(key);
+		if (found == states.end()) {
+			if (states.size() >= max_states)
+				return nullptr;
+			found = states.emplace(std::move(key), make_state(next, false)).first;
+		}
+
+		s.next[cls].store(found->second.get(), std::memory_order_release);
+		return found->second.get();
+	}
+
+	// Thompson-simulation of the NFA from p on, threads are those at p or
+	// null to start with p being the beginning of the subject
+	void simulate(const std::vector<std::uint32_t> *threads, const unsigned char *p, const unsigned char *end, match_set &result) const
+	{
+		thread_list current(code.size()), next(code.size());
+		std::vector<std::uint32_t> stack, found;
+
+		bool has_next = p != end;
+		code_point c = has_next ? decode(p, end) : 0;
+		context ctx{threads == nullptr, false, false, has_next && is_word(c)};
+
+		if (threads)
+			current.pcs = *threads;
+		else
+			closure(0, ctx, current, stack);
+
+		for (;;) {
+			if (current.matched) {
+				found.clear();
+				matches(current.pcs, found);
+				result.insert(found);
+				if (result.complete())
+					return;
+			}
+
+			if (!has_next) {
+				found.clear();
+				matches_at_end(current.pcs, ctx, found);
+				result.insert(found);
+				return;
+			}
+
+			const bool prev_word = is_word(c);
+			const code_point consumed = c;
+			has_next = p != end;
+			c = has_next ? decode(p, end) : 0;
+			ctx = {false, false, prev_word, has_next && is_word(c)};
+
+			step(current.pcs, consumed, ctx, next, stack);
+			std::swap(current, next);
+		}
+	}
+
+	void scan(const std::string &subject, match_set &result)
+	{
+		auto p = reinterpret_cast<const unsigned char *>(subject.data());
+		auto end = p + subject.size();
+
+		if (word_boundaries)
+			return simulate(nullptr, p, end, result);
+
+		std::call_once(prepared, [this] { prepare(); });
+
+		const dfa_state *s = start.get();
+		for (;;) {
+			if (!s->matches.empty()) {
+				result.insert(s->matches);
+				if (result.complete())
+					return;
+			}
+			if (p == end)
+				return result.insert(s->end_matches);
+			if (s->threads.empty()) // no thread can be started anymore, e.g. after a ^
+				return;
+
+			auto position = p;
+			code_point c = *p < 0x80 ? *p++ : decode(p, end);
+			auto cls = class_of(c);
+
+			auto next = s->next[cls].load(std::memory_order_acquire);
+			if (!next)
+				next = transition(*s, cls);
+			if (!next) // too many states, continue without caching
+				return simulate(&s->threads, position, end, result);
+			s = next;
+		}
+	}
+};
+
+linear_regex::linear_regex(const std::string &pattern)
+    : program_(new program({pattern}))
+{
+}
+
+linear_regex::linear_regex(const std::vector<std::string> &patterns)
+    : program_(new program(patterns))
+{
+}
+
+linear_regex::~linear_regex() = default;
+
+linear_regex::linear_regex(linear_regex &&) noexcept = default;
+linear_regex &linear_regex::operator=(linear_regex &&) noexcept = default;
+
+bool linear_regex::search(const std::string &subject) const
+{
+	if (program_->special.kind != specialization::none)
+		return program_->special.search(subject);
+
+	match_set result(program_->patterns, 1);
+	program_->scan(subject, result);
+	return !result.empty();
+}
+
+void linear_regex::search_all(const std::string &subject, std::vector<std::size_t> &matches) const
+{
+	if (program_->special.kind != specialization::none) {
+		matches.clear();
+		if (program_->special.search(subject))
+			matches.push_back(0);
+		return;
+	}
+
+	match_set result(program_->patterns, program_->patterns);
+	program_->scan(subject, result);
+	result.indices(matches);
+}
+
+std::u32string utf8_code_points(const std::string &s)
+{
+	std::u32string code_points;
+	auto p = reinterpret_cast<const unsigned char *>(s.data());
+	auto end = p + s.size();
+	while (p != end)
+		code_points.push_back(decode(p, end));
+	return code_points;
+}
+
+} // namespace json_schema
+} // namespace nlohmann
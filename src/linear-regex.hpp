@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace nlohmann
+{
+namespace json_schema
+{
+
+// thrown for patterns using constructs the linear_regex does not implement
+class regex_unsupported : public std::runtime_error
+{
+public:
+	using std::runtime_error::runtime_error;
+};
+
+/**
+ * Regular expressions of the ECMAScript-subset used by JSON schemas, matched
+ * in time linear to the length of the subject.
+ *
+ * One or more patterns are compiled into a single Thompson-NFA over the code
+ * points of UTF-8 strings, which tells which of them match in one scan. It is
+ * run as a DFA which is built lazily, from the first search on, and shared by
+ * all threads; once its number of states reaches a bound the NFA is simulated
+ * directly instead.
+ * Patterns with word-boundaries are always simulated. A single pattern of a
+ * trivial shape - a literal, possibly anchored, or an anchored run of an ASCII
+ * class like ^[a-z0-9_]+$ - is checked by a dedicated scanner instead.
+ *
+ * Backreferences, lookarounds, named groups and anything else which is not
+ * understood is rejected with regex_unsupported - including syntax errors,
+ * which are left to the fallback to report.
+ */
+class linear_regex
+{
+	struct program;
+	std::unique_ptr<program> program_;
+
+public:
+	explicit linear_regex(const std::string &pattern);
+	explicit linear_regex(const std::vector<std::string> &patterns);
+	~linear_regex();
+
+	linear_regex(linear_regex &&) noexcept;
+	linear_regex &operator=(linear_regex &&) noexcept;
+
+	// whether a pattern matches anywhere in subject
+	bool search(const std::string &subject) const;
+
+	// indices of all patterns matching anywhere in subject, ascending
+	void search_all(const std::string &subject, std::vector<std::size_t> &matches) const;
+};
+
+// the code points of an UTF-8 string as the linear_regex matches them, for other
+// engines to match the same - invalid bytes are code points beyond Unicode
+std::u32string utf8_code_points(const std::string &s);
+
+} // namespace json_schema
+} // namespace nlohmann
@@ -21,8 +21,22 @@
 #	define JSON_SCHEMA_VALIDATOR_API
 #endif
 
+#if (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) < 201703L
+#	error "json-schema-validator 3 requires C++17: its checkers take std::string_view"
+#endif
+
 #include <nlohmann/json.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
 #ifdef NLOHMANN_JSON_VERSION_MAJOR
 #	if (NLOHMANN_JSON_VERSION_MAJOR * 10000 + NLOHMANN_JSON_VERSION_MINOR * 100 + NLOHMANN_JSON_VERSION_PATCH) < 30800
 #		error "Please use this library with NLohmann's JSON version 3.8.0 or higher"
@@ -130,9 +144,258 @@ namespace json_schema
 
 extern json draft7_schema_builtin;
 
+/**
+ * Outcome of a check which returns its failure instead of throwing it: success,
+ * or a code and a message which is only built when asked for. The message may
+ * refer to the checked strings, it is to be built while they exist.
+ */
+class check_status
+{
+	int code_ = success;
+	std::string_view value_;
+	const char *reason_ = "";
+	std::function<std::string()> message_;
+
+public:
+	// codes of the built-in checks, any code but success is a failure
+	enum : int {
+		success = 0,
+		invalid,      // not of the syntax of the format
+		out_of_range, // a part of it is out of range, like the 31st of April
+		thrown,       // a throwing checker threw, the message is what() it threw
+	};
+
+	check_status() = default;
+
+	// failed, with the message value followed by reason - a string-literal
+	check_status(int code, std::string_view value, const char *reason)
+	    : code_(code), value_(value), reason_(reason) {}
+
+	check_status(int code, std::function<std::string()> message)
+	    : code_(code), message_(std::move(message)) {}
+
+	check_status(int code, std::string message)
+	    : code_(code), message_([message] { return message; }) {}
+
+	bool ok() const { return code_ == success; }
+	int code() const { return code_; }
+
+	std::string message() const
+	{
+		if (message_)
+			return message_();
+		return std::string(value_) + reason_;
+	}
+};
+
+/**
+ * Callback taking views of strings, or - for callables which only take them
+ * as std::string like checkers used to - the strings themselves. Either way
+ * the strings of schema and instance are passed without being copied.
+ *
+ * Callables returning a check_status report failures with it, the others by
+ * throwing. check() gives the status of both, operator() throws for both.
+ */
+template <typename ViewSignature, typename StringSignature>
+class checker_function;
+
+template <typename... Views, typename... Strings>
+class checker_function<void(Views...), void(Strings...)>
+{
+	std::function<check_status(Strings...)> status_;
+	std::function<void(Views...)> view_;
+	std::function<void(Strings...)> string_;
+
+	template <typename F>
+	using returns_status = std::is_invocable_r<check_status, F &, Strings...>;
+
+public:
+	checker_function() = default;
+	checker_function(std::nullptr_t) {}
+
+	template <typename F, typename std::enable_if<returns_status<F>::value, int>::type = 0>
+	checker_function(F f)
+	    : status_(std::move(f)) {}
+
+	template <typename F, typename std::enable_if<!returns_status<F>::value &&
+	                                                  std::is_invocable<F &, Views...>::value,
+	                                              int>::type = 0>
+	checker_function(F f)
+	    : view_(std::move(f)) {}
+
+	template <typename F, typename std::enable_if<!returns_status<F>::value &&
+	                                                  !std::is_invocable<F &, Views...>::value &&
+	                                                  std::is_invocable<F &, Strings...>::value,
+	                                              int>::type = 0>
+	checker_function(F f)
+	    : string_(std::move(f)) {}
+
+	explicit operator bool() const { return status_ || view_ || string_; }
+	friend bool operator==(const checker_function &f, std::nullptr_t) { return !f; }
+	friend bool operator!=(const checker_function &f, std::nullptr_t) { return !!f; }
+
+	void operator()(Strings... args) const
+	{
+		if (status_) {
+			auto status = status_(args...);
+			if (!status.ok())
+				throw std::invalid_argument(status.message());
+		} else if (view_)
+			view_(args...);
+		else
+			string_(args...);
+	}
+
+	check_status check(Strings... args) const
+	{
+		if (status_)
+			return status_(args...);
+
+		try {
+			(*this)(args...);
+		} catch (const std::exception &e) {
+			return {check_status::thrown, std::string(e.what())};
+		}
+		return {};
+	}
+
+	// the wrapped callable if it is a T, like std::function::target()
+	template <typename T>
+	const T *target() const
+	{
+		if (status_)
+			return status_.template target<T>();
+		return view_ ? view_.template target<T>() : string_.template target<T>();
+	}
+};
+
 typedef std::function<void(const json_uri & /*id*/, json & /*value*/)> schema_loader;
-typedef std::function<void(const std::string & /*format*/, const std::string & /*value*/)> format_checker;
-typedef std::function<void(const std::string & /*contentEncoding*/, const std::string & /*contentMediaType*/, const json & /*instance*/)> content_checker;
+typedef checker_function<void(std::string_view /*format*/, std::string_view /*value*/),
+                         void(const std::string & /*format*/, const std::string & /*value*/)>
+    format_checker;
+// checker of the values of one format
+typedef checker_function<void(std::string_view /*value*/), void(const std::string & /*value*/)> format_value_checker;
+typedef checker_function<void(std::string_view /*contentEncoding*/, std::string_view /*contentMediaType*/, const json & /*instance*/),
+                         void(const std::string & /*contentEncoding*/, const std::string & /*contentMediaType*/, const json & /*instance*/)>
+    content_checker;
+
+// keyword or reason of a validation error
+enum class error_code {
+	unresolved_reference,
+	false_schema,
+	unexpected_type,
+	not_in_enum,
+	not_const,
+	not_succeeded, // the subschema of "not" has succeeded
+	all_of,        // a subschema has failed (cause is its first error)
+	any_of,        // no subschema has succeeded
+	one_of,        // no subschema has succeeded
+	one_of_multiple,
+	expected_null,
+	multiple_of,
+	maximum,
+	exclusive_maximum,
+	minimum,
+	exclusive_minimum,
+	min_length,
+	max_length,
+	content_checker_missing,
+	content,
+	unexpected_binary,
+	pattern,
+	format_checker_missing,
+	format,
+	max_properties,
+	min_properties,
+	required,
+	additional_properties, // cause is the first error of the additionalProperties-schema
+	dependency_required,
+	max_items,
+	min_items,
+	unique_items,
+	contains,
+};
+
+/**
+ * Location of the instance being validated: a chain of object-keys and
+ * array-indices up to the root, which lives on the stack of the validator.
+ * It is only turned into a json_pointer when to_pointer() is called.
+ */
+class JSON_SCHEMA_VALIDATOR_API instance_path
+{
+	const instance_path *parent_ = nullptr;
+	const std::string *key_ = nullptr;
+	std::size_t index_ = 0;
+
+public:
+	instance_path() = default; // the root
+
+	instance_path(const instance_path &parent, const std::string &key)
+	    : parent_(&parent), key_(&key) {}
+	instance_path(const instance_path &parent, std::string &&key) = delete; // key has to outlive the path
+
+	instance_path(const instance_path &parent, std::size_t index)
+	    : parent_(&parent), index_(index) {}
+
+	const instance_path *parent() const { return parent_; }
+
+	// key of an object-member, nullptr for array-elements
+	const std::string *key() const { return key_; }
+	std::size_t index() const { return index_; }
+
+	json::json_pointer to_pointer() const;
+};
+
+/**
+ * A validation error as reported to error_handler::error(). It only refers to
+ * the data describing the error, which is valid for the duration of the call.
+ * The human readable message is created on request by message().
+ */
+class JSON_SCHEMA_VALIDATOR_API error_record
+{
+	error_code code_;
+	const instance_path &path_;
+	const json &instance_;
+	const std::string &schema_location_;
+	const json *limit_;
+	const std::string *detail_;
+	const error_record *cause_;
+	const std::string *prefix_;
+
+public:
+	error_record(error_code code,
+	             const instance_path &path,
+	             const json &instance,
+	             const std::string &schema_location,
+	             const json *limit = nullptr,
+	             const std::string *detail = nullptr,
+	             const error_record *cause = nullptr,
+	             const std::string *prefix = nullptr)
+	    : code_(code), path_(path), instance_(instance), schema_location_(schema_location),
+	      limit_(limit), detail_(detail), cause_(cause), prefix_(prefix) {}
+
+	error_code code() const { return code_; }
+	const instance_path &path() const { return path_; }
+	json::json_pointer ptr() const { return path_.to_pointer(); }
+	const json &instance() const { return instance_; }
+
+	// URI of the schema containing the failing keyword
+	const std::string &schema_location() const { return schema_location_; }
+
+	// value of the failing keyword (maximum, pattern, enum, ...), nullptr if there is none
+	const json *limit() const { return limit_; }
+
+	// property-name or the message of a format- or content-checker, nullptr if there is none
+	const std::string *detail() const { return detail_; }
+
+	// error of a subschema which led to this error, nullptr if there is none
+	const error_record *cause() const { return cause_; }
+
+	// subschema-case of allOf, anyOf and oneOf this error has been propagated from, nullptr if none
+	const std::string *prefix() const { return prefix_; }
+
+	std::string message() const;
+};
 
 // Interface for validation error handlers
 class JSON_SCHEMA_VALIDATOR_API error_handler
@@ -140,6 +403,13 @@ class JSON_SCHEMA_VALIDATOR_API error_handler
 public:
 	virtual ~error_handler() {}
 	virtual void error(const json::json_pointer & /*ptr*/, const json & /*instance*/, const std::string & /*message*/) = 0;
+
+	// called by the validator for each error, by default the message is rendered and passed
+	// to the error()-method above - override it to avoid creating messages
+	virtual void error(const error_record &record)
+	{
+		error(record.ptr(), record.instance(), record.message());
+	}
 };
 
 class JSON_SCHEMA_VALIDATOR_API basic_error_handler : public error_handler
@@ -161,8 +431,58 @@ public:
  */
 void JSON_SCHEMA_VALIDATOR_API default_string_format_check(const std::string &format, const std::string &value);
 
+/**
+ * The check default_string_format_check does for one format, nullptr if it does
+ * not support it.
+ */
+format_value_checker JSON_SCHEMA_VALIDATOR_API default_string_format(const std::string &format);
+
 class root_schema;
 
+// Work-stealing pool of threads, on which a json_validator validates the items
+// of large arrays and the members of large objects in parallel. It can be
+// shared by validators.
+class JSON_SCHEMA_VALIDATOR_API thread_pool
+{
+	struct impl;
+	std::unique_ptr<impl> impl_;
+
+public:
+	// threads in addition to the ones waiting for their tasks, 0 for one per core
+	explicit thread_pool(std::size_t threads = 0);
+	~thread_pool();
+
+	thread_pool(const thread_pool &) = delete;
+	thread_pool &operator=(const thread_pool &) = delete;
+
+	std::size_t size() const;
+
+	// calls task(i) for each i in [0, n) on the threads of the pool and on the
+	// calling one, returns when all calls have returned - the first exception
+	// thrown by one of them is rethrown
+	void parallel_for(std::size_t n, const std::function<void(std::size_t)> &task);
+};
+
+// hits and misses of the cache of the outcomes of a format's checks
+struct format_cache_stats {
+	std::uint64_t hits = 0, misses = 0;
+};
+
+// how json_validator::validate_batch() checks each document
+enum class batch_mode {
+	fail_fast,  // like is_valid(): stops at the first error, no error-messages
+	all_errors, // like validate() with an error_handler: counts all errors
+};
+
+// outcome of a document of validate_batch() - in all_errors-mode errors counts
+// all errors, of which only the first one's location and message are kept
+struct batch_result {
+	bool valid = true;
+	std::size_t errors = 0;
+	json::json_pointer first_error_ptr;
+	std::string first_error;
+};
+
 class JSON_SCHEMA_VALIDATOR_API json_validator
 {
 	std::unique_ptr<root_schema> root_;
@@ -181,6 +501,33 @@ public:
 
 	~json_validator();
 
+	// check the values of a format with its own checker instead of the
+	// format_checker - formats are bound when the root-schema is set, so they
+	// have to be added before
+	void add_format(const std::string &format, format_value_checker);
+
+	// remember the outcomes of the checks of format for recently checked values
+	// of up to 64 bytes, in a cache of entries values of all cached formats - its
+	// checks have to give the same outcome for the same value. Like add_format
+	// before the root-schema is set.
+	void cache_format(const std::string &format);
+	void set_format_cache_size(std::size_t entries);
+	format_cache_stats cache_stats(const std::string &format) const;
+
+	// remember for up to entries recently seen names of up to 256 bytes per
+	// object of the schema which of its properties, patternProperties or
+	// additionalProperties validate a member, so that a repeated name is not
+	// looked up and matched again - 0, the default, does not. Like add_format
+	// before the root-schema is set.
+	void cache_object_keys(std::size_t entries);
+
+	// validate the items of arrays and the members of objects in parallel when
+	// there are at least threshold of them, on pool or, if null, on a pool of
+	// the validator - 0 validates serially. Errors and default values are
+	// reported in the same order as when validating serially, format- and
+	// content-checkers have to be thread-safe. Not while validating.
+	void set_parallel(std::size_t threshold, std::shared_ptr<thread_pool> pool = nullptr);
+
 	// insert and set the root-schema
 	void set_root_schema(const json &);
 	void set_root_schema(json &&);
@@ -190,6 +537,20 @@ public:
 
 	// validate a json-document based on the root-schema with a custom error-handler
 	json validate(const json &, error_handler &, const json_uri &initial_uri = json_uri("#")) const;
+
+	// check a json-document against the root-schema, stops at the first error - no
+	// error-messages are created and no default-values are collected
+	bool is_valid(const json &) const;
+
+	// validate count documents against the root-schema on pool or, if null, on
+	// the pool of set_parallel() or else on the pool of the validator, created
+	// once and kept - the outcome of documents[i] is written to results[i]. No
+	// default-values are collected, format- and content-checkers have to be
+	// thread-safe - the first exception thrown while validating is rethrown.
+	void validate_batch(const json *documents, std::size_t count, batch_result *results,
+	                    batch_mode mode = batch_mode::fail_fast, thread_pool *pool = nullptr) const;
+	std::vector<batch_result> validate_batch(const std::vector<json> &documents,
+	                                         batch_mode mode = batch_mode::fail_fast, thread_pool *pool = nullptr) const;
 };
 
 } // namespace json_schema
@@ -1,15 +1,17 @@
 #include <nlohmann/json-schema.hpp>
 
+#include "idn-hostname.hpp"
+#include "key-cache.hpp"
 #include "smtp-address-validator.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <exception>
 #include <iostream>
 #include <regex>
-#include <sstream>
 #include <string>
 #include <utility>
-#include <vector>
 
 #ifdef JSON_SCHEMA_BOOST_REGEX
 #	include <boost/regex.hpp>
@@ -22,75 +24,217 @@
 #endif
 
 /**
- * Many of the RegExes are from @see http://jmrware.com/articles/2009/uri_regexp/URI_regex.html
+ * The formats are scanned by hand along their grammars, accepting exactly what the
+ * RegExes they were first checked with did - many of which were from
+ * @see http://jmrware.com/articles/2009/uri_regexp/URI_regex.html
  */
 
 namespace
 {
-template <typename T>
-void range_check(const T value, const T min, const T max)
+using nlohmann::json_schema::check_status;
+
+check_status range_check(const int value, const int min, const int max)
 {
-	if (!((value >= min) && (value <= max))) {
-		std::stringstream out;
-		out << "Value " << value << " should be in interval [" << min << "," << max << "] but is not!";
-		throw std::invalid_argument(out.str());
-	}
+	if ((value >= min) && (value <= max))
+		return {};
+
+	return {check_status::out_of_range, [value, min, max] {
+		        return "Value " + std::to_string(value) + " should be in interval [" + std::to_string(min) + "," +
+		               std::to_string(max) + "] but is not!";
+	        }};
 }
 
-/** @see date_time_check */
-void rfc3339_date_check(const std::string &value)
+// classes of the characters of the grammars, as bits per byte
+enum : std::uint16_t {
+	digit = 1 << 0,
+	hex_digit = 1 << 1,
+	alpha = 1 << 2,
+	scheme_char = 1 << 3,   // ALPHA / DIGIT / "+" / "-" / "."
+	unreserved = 1 << 4,    // unreserved / sub-delims, of reg-name
+	userinfo_char = 1 << 5, // unreserved / sub-delims / ":", also of IPvFuture
+	pchar = 1 << 6,         // unreserved / sub-delims / ":" / "@"
+	path_char = 1 << 7,     // pchar / "/"
+	query_char = 1 << 8,    // pchar / "/" / "?", also of fragment
+	label_char = 1 << 9,    // ALPHA / DIGIT / "-" of hostname labels
+	ucs_char = 1 << 10,     // all non-ASCII, ucschar and iprivate of IRIs
+	literal_char = 1 << 11, // of URI template literals
+};
+
+const std::array<std::uint16_t, 256> &char_classes()
+{
+	static const std::array<std::uint16_t, 256> classes = [] {
+		std::array<std::uint16_t, 256> table{};
+		auto add = [&](const char *chars, std::uint16_t bits) {
+			for (; *chars; chars++)
+				table[static_cast<unsigned char>(*chars)] |= bits;
+		};
+		for (int c = 0; c < 256; c++) {
+			if (c >= '0' && c <= '9')
+				table[c] |= digit | hex_digit;
+			if ((c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'))
+				table[c] |= hex_digit;
+			if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+				table[c] |= alpha;
+			if (table[c] & (digit | alpha))
+				table[c] |= scheme_char | unreserved | label_char;
+		}
+		add("+-.", scheme_char);
+		add("-._~!$&'()*+,;=", unreserved);
+		add("-", label_char);
+		for (int c = 0; c < 256; c++)
+			if (table[c] & unreserved)
+				table[c] |= userinfo_char | pchar;
+		add(":", userinfo_char | pchar);
+		add("@", pchar);
+		for (int c = 0; c < 256; c++)
+			if (table[c] & pchar)
+				table[c] |= path_char | query_char;
+		add("/", path_char | query_char);
+		add("?", query_char);
+		for (int c = 0x21; c < 0x7f; c++)
+			table[c] |= literal_char;
+		for (auto c : "\"'%<>\\^`{|}")
+			table[static_cast<unsigned char>(c)] &= ~literal_char;
+		for (int c = 0x80; c < 256; c++)
+			table[c] |= ucs_char | literal_char;
+		return table;
+	}();
+	return classes;
+}
+
+bool is(char c, std::uint16_t cls)
+{
+	return char_classes()[static_cast<unsigned char>(c)] & cls;
+}
+
+// whether the n characters at p are decimal digits
+bool digits(const char *p, std::size_t n)
 {
-	const static REGEX_NAMESPACE::regex dateRegex{R"(^([0-9]{4})\-([0-9]{2})\-([0-9]{2})$)"};
+	for (std::size_t i = 0; i < n; i++)
+		if (!is(p[i], digit))
+			return false;
+	return true;
+}
 
-	REGEX_NAMESPACE::smatch matches;
-	if (!REGEX_NAMESPACE::regex_match(value, matches, dateRegex)) {
-		throw std::invalid_argument(value + " is not a date string according to RFC 3339.");
+int number(const char *p, std::size_t n)
+{
+	int value = 0;
+	for (std::size_t i = 0; i < n; i++)
+		value = value * 10 + (p[i] - '0');
+	return value;
+}
+
+// *( allowed / pct-encoded )
+bool encoded(const char *p, const char *end, std::uint16_t allowed)
+{
+	while (p != end) {
+		if (*p == '%') {
+			if (end - p < 3 || !is(p[1], hex_digit) || !is(p[2], hex_digit))
+				return false;
+			p += 3;
+		} else if (is(*p, allowed))
+			p++;
+		else
+			return false;
 	}
+	return true;
+}
 
-	const auto year = std::stoi(matches[1].str());
-	const auto month = std::stoi(matches[2].str());
-	const auto mday = std::stoi(matches[3].str());
+struct full_date {
+	int year, month, mday;
+};
 
-	const auto isLeapYear = (year % 4 == 0) && ((year % 100 != 0) || (year % 400 == 0));
+// date-fullyear "-" date-month "-" date-mday, as digits only
+bool parse_date(const char *p, const char *end, full_date &date)
+{
+	if (end - p != 10 || !digits(p, 4) || p[4] != '-' || !digits(p + 5, 2) || p[7] != '-' || !digits(p + 8, 2))
+		return false;
 
-	range_check(month, 1, 12);
-	if (month == 2) {
-		range_check(mday, 1, isLeapYear ? 29 : 28);
-	} else if (month <= 7) {
-		range_check(mday, 1, month % 2 == 0 ? 30 : 31);
-	} else {
-		range_check(mday, 1, month % 2 == 0 ? 31 : 30);
+	date = {number(p, 4), number(p + 5, 2), number(p + 8, 2)};
+	return true;
+}
+
+struct full_time {
+	int hour, minute, second;
+	bool numeric_offset; // else "Z"
+	int offset_hour, offset_minute;
+};
+
+// partial-time time-offset, as digits only
+bool parse_time(const char *p, const char *end, full_time &time)
+{
+	if (end - p < 9 || !digits(p, 2) || p[2] != ':' || !digits(p + 3, 2) || p[5] != ':' || !digits(p + 6, 2))
+		return false;
+
+	time.hour = number(p, 2);
+	time.minute = number(p + 3, 2);
+	time.second = number(p + 6, 2);
+	p += 8;
+
+	// time-secfrac
+	if (*p == '.') {
+		auto fraction = ++p;
+		while (p != end && is(*p, digit))
+			p++;
+		if (p == fraction)
+			return false;
+	}
+
+	if (end - p == 1 && (*p == 'Z' || *p == 'z')) {
+		time.numeric_offset = false;
+		return true;
 	}
+
+	if (end - p == 6 && (*p == '+' || *p == '-') && digits(p + 1, 2) && p[3] == ':' && digits(p + 4, 2)) {
+		time.numeric_offset = true;
+		time.offset_hour = (*p == '-' ? -1 : 1) * number(p + 1, 2);
+		time.offset_minute = number(p + 4, 2);
+		return true;
+	}
+	return false;
 }
 
-/** @see date_time_check */
-void rfc3339_time_check(const std::string &value)
+check_status check_date(const full_date &date)
 {
-	const static REGEX_NAMESPACE::regex timeRegex{R"(^([0-9]{2})\:([0-9]{2})\:([0-9]{2})(\.[0-9]+)?(?:[Zz]|((?:\+|\-)[0-9]{2})\:([0-9]{2}))$)"};
+	const auto isLeapYear = (date.year % 4 == 0) && ((date.year % 100 != 0) || (date.year % 400 == 0));
 
-	REGEX_NAMESPACE::smatch matches;
-	if (!REGEX_NAMESPACE::regex_match(value, matches, timeRegex)) {
-		throw std::invalid_argument(value + " is not a time string according to RFC 3339.");
+	auto status = range_check(date.month, 1, 12);
+	if (!status.ok())
+		return status;
+
+	if (date.month == 2) {
+		return range_check(date.mday, 1, isLeapYear ? 29 : 28);
+	} else if (date.month <= 7) {
+		return range_check(date.mday, 1, date.month % 2 == 0 ? 30 : 31);
+	} else {
+		return range_check(date.mday, 1, date.month % 2 == 0 ? 31 : 30);
 	}
+}
 
-	auto hour = std::stoi(matches[1].str());
-	auto minute = std::stoi(matches[2].str());
-	auto second = std::stoi(matches[3].str());
-	// const auto secfrac      = std::stof( matches[4].str() );
+check_status check_time(const full_time &time)
+{
+	auto hour = time.hour;
+	auto minute = time.minute;
 
-	range_check(hour, 0, 23);
-	range_check(minute, 0, 59);
+	auto status = range_check(hour, 0, 23);
+	if (status.ok())
+		status = range_check(minute, 0, 59);
+	if (!status.ok())
+		return status;
 
 	int offsetHour = 0,
 	    offsetMinute = 0;
 
 	/* don't check the numerical offset if time zone is specified as 'Z' */
-	if (!matches[5].str().empty()) {
-		offsetHour = std::stoi(matches[5].str());
-		offsetMinute = std::stoi(matches[6].str());
-
-		range_check(offsetHour, -23, 23);
-		range_check(offsetMinute, 0, 59);
+	if (time.numeric_offset) {
+		offsetHour = time.offset_hour;
+		offsetMinute = time.offset_minute;
+
+		status = range_check(offsetHour, -23, 23);
+		if (status.ok())
+			status = range_check(offsetMinute, 0, 59);
+		if (!status.ok())
+			return status;
 		if (offsetHour < 0)
 			offsetMinute *= -1;
 	}
@@ -108,9 +252,27 @@ void rfc3339_time_check(const std::string &value)
 	minute = day_minutes / 24;
 
 	if (hour == 23 && minute == 59)
-		range_check(second, 0, 60); // possible leap-second
+		return range_check(time.second, 0, 60); // possible leap-second
 	else
-		range_check(second, 0, 59);
+		return range_check(time.second, 0, 59);
+}
+
+/** @see date_time_check */
+check_status rfc3339_date_check(std::string_view value)
+{
+	full_date date;
+	if (!parse_date(value.data(), value.data() + value.size(), date))
+		return {check_status::invalid, value, " is not a date string according to RFC 3339."};
+	return check_date(date);
+}
+
+/** @see date_time_check */
+check_status rfc3339_time_check(std::string_view value)
+{
+	full_time time;
+	if (!parse_time(value.data(), value.data() + value.size(), time))
+		return {check_status::invalid, value, " is not a time string according to RFC 3339."};
+	return check_time(time);
 }
 
 /**
@@ -139,60 +301,129 @@ void rfc3339_time_check(const std::string &value)
  * NOTE: Per [ABNF] and ISO8601, the "T" and "Z" characters in this
  *       syntax may alternatively be lower case "t" or "z" respectively.
  */
-void rfc3339_date_time_check(const std::string &value)
+check_status rfc3339_date_time_check(std::string_view value)
+{
+	const char *p = value.data(), *end = p + value.size();
+
+	full_date date;
+	full_time time;
+	if (value.size() < 11 || (p[10] != 'T' && p[10] != 't') || !parse_date(p, p + 10, date) || !parse_time(p + 11, end, time))
+		return {check_status::invalid, value, " is not a date-time string according to RFC 3339."};
+
+	auto status = check_date(date);
+	return status.ok() ? check_time(time) : status;
+}
+
+// dec-octet "." dec-octet "." dec-octet "." dec-octet - the URI grammar's dec-octets
+// had leading zeros
+bool parse_ipv4(const char *p, const char *end, bool leading_zeros)
+{
+	for (int i = 0; i < 4; i++) {
+		if (i > 0) {
+			if (p == end || *p != '.')
+				return false;
+			p++;
+		}
+
+		auto octet = p;
+		int value = 0;
+		while (p != end && p - octet < 3 && is(*p, digit))
+			value = value * 10 + (*p++ - '0');
+
+		if (p == octet || value > 255 || (!leading_zeros && p - octet > 1 && *octet == '0'))
+			return false;
+	}
+	return p == end;
+}
+
+/**
+ * @verbatim
+ * IPv6address   =                            6( h16 ":" ) ls32
+ *               /                       "::" 5( h16 ":" ) ls32
+ *               / [               h16 ] "::" 4( h16 ":" ) ls32
+ *               / [ *1( h16 ":" ) h16 ] "::" 3( h16 ":" ) ls32
+ *               / [ *2( h16 ":" ) h16 ] "::" 2( h16 ":" ) ls32
+ *               / [ *3( h16 ":" ) h16 ] "::"    h16 ":"   ls32
+ *               / [ *4( h16 ":" ) h16 ] "::"              ls32
+ *               / [ *5( h16 ":" ) h16 ] "::"              h16
+ *               / [ *6( h16 ":" ) h16 ] "::"
+ * @endverbatim
+ *
+ * which is: 8 pieces without "::", or at most 7 around one "::" - pieces are
+ * h16s, the last may be an IPv4address counting as two
+ */
+bool parse_ipv6(const char *p, const char *end, bool ipv4_leading_zeros)
+{
+	int before = 0, after = 0; // pieces before and after the "::"
+	bool compressed = false;
+
+	if (end - p >= 2 && p[0] == ':' && p[1] == ':') {
+		compressed = true;
+		p += 2;
+	}
+
+	while (p != end) {
+		auto piece = p;
+		while (p != end && p - piece < 4 && is(*p, hex_digit))
+			p++;
+
+		if (p != end && *p == '.') {
+			if (!parse_ipv4(piece, end, ipv4_leading_zeros))
+				return false;
+			(compressed ? after : before) += 2;
+			break;
+		}
+
+		if (p == piece)
+			return false;
+		(compressed ? after : before)++;
+
+		if (p == end)
+			break;
+		if (*p++ != ':' || p == end)
+			return false;
+		if (*p == ':') {
+			if (compressed)
+				return false;
+			compressed = true;
+			p++;
+		}
+	}
+
+	return compressed ? before + after <= 7 : before == 8;
+}
+
+bool parse_uuid(std::string_view value)
+{
+	if (value.size() != 36)
+		return false;
+
+	for (std::size_t i = 0; i < 36; i++)
+		if (i == 8 || i == 13 || i == 18 || i == 23 ? value[i] != '-' : !is(value[i], hex_digit))
+			return false;
+	return true;
+}
+
+// labels of 1 to 63 letters, digits and hyphens, which neither begin nor end with
+// a hyphen, separated by dots
+bool parse_hostname(std::string_view value)
 {
-	const static REGEX_NAMESPACE::regex dateTimeRegex{R"(^([0-9]{4}\-[0-9]{2}\-[0-9]{2})[Tt]([0-9]{2}\:[0-9]{2}\:[0-9]{2}(?:\.[0-9]+)?(?:[Zz]|(?:\+|\-)[0-9]{2}\:[0-9]{2}))$)"};
+	const char *p = value.data(), *end = p + value.size();
+	for (;;) {
+		auto label = p;
+		while (p != end && is(*p, label_char))
+			p++;
 
-	REGEX_NAMESPACE::smatch matches;
-	if (!REGEX_NAMESPACE::regex_match(value, matches, dateTimeRegex)) {
-		throw std::invalid_argument(value + " is not a date-time string according to RFC 3339.");
+		if (p == label || p - label > 63 || *label == '-' || p[-1] == '-')
+			return false;
+		if (p == end)
+			return true;
+		if (*p++ != '.')
+			return false;
 	}
+}
 
-	rfc3339_date_check(matches[1].str());
-	rfc3339_time_check(matches[2].str());
-}
-
-const std::string decOctet{R"((?:25[0-5]|2[0-4][0-9]|1[0-9][0-9]|[1-9]?[0-9]))"}; // matches numbers 0-255
-const std::string ipv4Address{"(?:" + decOctet + R"(\.){3})" + decOctet};
-const std::string h16{R"([0-9A-Fa-f]{1,4})"};
-const std::string h16Left{"(?:" + h16 + ":)"};
-const std::string ipv6Address{
-    "(?:"
-    "(?:" +
-    h16Left + "{6}"
-              "|::" +
-    h16Left + "{5}"
-              "|(?:" +
-    h16 + ")?::" + h16Left + "{4}"
-                             "|(?:" +
-    h16Left + "{0,1}" + h16 + ")?::" + h16Left + "{3}"
-                                                 "|(?:" +
-    h16Left + "{0,2}" + h16 + ")?::" + h16Left + "{2}"
-                                                 "|(?:" +
-    h16Left + "{0,3}" + h16 + ")?::" + h16Left +
-    "|(?:" + h16Left + "{0,4}" + h16 + ")?::"
-                                       ")(?:" +
-    h16Left + h16 + "|" + ipv4Address + ")"
-                                        "|(?:" +
-    h16Left + "{0,5}" + h16 + ")?::" + h16 +
-    "|(?:" + h16Left + "{0,6}" + h16 + ")?::"
-                                       ")"};
-const std::string ipvFuture{R"([Vv][0-9A-Fa-f]+\.[A-Za-z0-9\-._~!$&'()*+,;=:]+)"};
-const std::string regName{R"((?:[A-Za-z0-9\-._~!$&'()*+,;=]|%[0-9A-Fa-f]{2})*)"};
-const std::string host{
-    "(?:"
-    R"(\[(?:)" +
-    ipv6Address + "|" + ipvFuture + R"()\])" +
-    "|" + ipv4Address +
-    "|" + regName +
-    ")"};
-
-const std::string uuid{R"([0-9a-fA-F]{8}\-[0-9a-fA-F]{4}\-[0-9a-fA-F]{4}\-[0-9a-fA-F]{4}\-[0-9a-fA-F]{12})"};
-
-// from http://stackoverflow.com/questions/106179/regular-expression-to-match-dns-hostname-or-ip-address
-const std::string hostname{R"(^([a-zA-Z0-9]|[a-zA-Z0-9][a-zA-Z0-9\-]{0,61}[a-zA-Z0-9])(\.([a-zA-Z0-9]|[a-zA-Z0-9][a-zA-Z0-9\-]{0,61}[a-zA-Z0-9]))*$)"};
-
-bool is_ascii(std::string const &value)
+bool is_ascii(std::string_view value)
 {
 	for (auto ch : value) {
 		if (ch & 0x80) {
@@ -291,124 +522,378 @@ bool is_ascii(std::string const &value)
  * @see adapted from: https://github.com/jhermsmeier/uri.regex/blob/master/uri.regex
  *
  */
-void rfc3986_uri_check(const std::string &value)
-{
-	const static std::string scheme{R"(([A-Za-z][A-Za-z0-9+\-.]*):)"};
-	const static std::string hierPart{
-	    R"((?:(\/\/)(?:((?:[A-Za-z0-9\-._~!$&'()*+,;=:]|)"
-	    R"(%[0-9A-Fa-f]{2})*)@)?((?:\[(?:(?:(?:(?:[0-9A-Fa-f]{1,4}:){6}|)"
-	    R"(::(?:[0-9A-Fa-f]{1,4}:){5}|)"
-	    R"((?:[0-9A-Fa-f]{1,4})?::(?:[0-9A-Fa-f]{1,4}:){4}|)"
-	    R"((?:(?:[0-9A-Fa-f]{1,4}:){0,1}[0-9A-Fa-f]{1,4})?::(?:[0-9A-Fa-f]{1,4}:){3}|)"
-	    R"((?:(?:[0-9A-Fa-f]{1,4}:){0,2}[0-9A-Fa-f]{1,4})?::(?:[0-9A-Fa-f]{1,4}:){2}|)"
-	    R"((?:(?:[0-9A-Fa-f]{1,4}:){0,3}[0-9A-Fa-f]{1,4})?::[0-9A-Fa-f]{1,4}:|)"
-	    R"((?:(?:[0-9A-Fa-f]{1,4}:){0,4}[0-9A-Fa-f]{1,4})?::)(?:[0-9A-Fa-f]{1,4}:[0-9A-Fa-f]{1,4}|)"
-	    R"((?:(?:25[0-5]|2[0-4][0-9]|)"
-	    R"([01]?[0-9][0-9]?)\.){3}(?:25[0-5]|)"
-	    R"(2[0-4][0-9]|)"
-	    R"([01]?[0-9][0-9]?))|)"
-	    R"((?:(?:[0-9A-Fa-f]{1,4}:){0,5}[0-9A-Fa-f]{1,4})?::[0-9A-Fa-f]{1,4}|)"
-	    R"((?:(?:[0-9A-Fa-f]{1,4}:){0,6}[0-9A-Fa-f]{1,4})?::)|)"
-	    R"([Vv][0-9A-Fa-f]+\.[A-Za-z0-9\-._~!$&'()*+,;=:]+)\]|)"
-	    R"((?:(?:25[0-5]|)"
-	    R"(2[0-4][0-9]|)"
-	    R"([01]?[0-9][0-9]?)\.){3}(?:25[0-5]|)"
-	    R"(2[0-4][0-9]|)"
-	    R"([01]?[0-9][0-9]?)|)"
-	    R"((?:[A-Za-z0-9\-._~!$&'()*+,;=]|)"
-	    R"(%[0-9A-Fa-f]{2})*))(?::([0-9]*))?((?:\/(?:[A-Za-z0-9\-._~!$&'()*+,;=:@]|)"
-	    R"(%[0-9A-Fa-f]{2})*)*)|)"
-	    R"(\/((?:(?:[A-Za-z0-9\-._~!$&'()*+,;=:@]|)"
-	    R"(%[0-9A-Fa-f]{2})+(?:\/(?:[A-Za-z0-9\-._~!$&'()*+,;=:@]|)"
-	    R"(%[0-9A-Fa-f]{2})*)*)?)|)"
-	    R"(((?:[A-Za-z0-9\-._~!$&'()*+,;=:@]|)"
-	    R"(%[0-9A-Fa-f]{2})+(?:\/(?:[A-Za-z0-9\-._~!$&'()*+,;=:@]|)"
-	    R"(%[0-9A-Fa-f]{2})*)*)|))"};
-
-	const static std::string query{R"((?:\?((?:[A-Za-z0-9\-._~!$&'()*+,;=:@\/?]|%[0-9A-Fa-f]{2})*))?)"};
-	const static std::string fragment{
-	    R"((?:\#((?:[A-Za-z0-9\-._~!$&'()*+,;=:@\/?]|%[0-9A-Fa-f]{2})*))?)"};
-	const static std::string uriFormat{scheme + hierPart + query + fragment};
-
-	const static REGEX_NAMESPACE::regex uriRegex{uriFormat};
-
-	if (!REGEX_NAMESPACE::regex_match(value, uriRegex)) {
-		throw std::invalid_argument(value + " is not a URI string according to RFC 3986.");
+// "[" ( IPv6address / IPvFuture ) "]" without the brackets
+bool parse_ip_literal(const char *p, const char *end)
+{
+	if (p == end || (*p != 'v' && *p != 'V'))
+		return parse_ipv6(p, end, true);
+
+	// "v" 1*HEXDIG "." 1*( unreserved / sub-delims / ":" )
+	auto version = ++p;
+	while (p != end && is(*p, hex_digit))
+		p++;
+	if (p == version || p == end || *p++ != '.' || p == end)
+		return false;
+	for (; p != end; p++)
+		if (!is(*p, userinfo_char))
+			return false;
+	return true;
+}
+
+// [ userinfo "@" ] host [ ":" port ]
+bool parse_authority(const char *p, const char *end, std::uint16_t extra)
+{
+	auto at = std::find(p, end, '@');
+	if (at != end) {
+		if (!encoded(p, at, userinfo_char | extra))
+			return false;
+		p = at + 1;
 	}
+
+	if (p != end && *p == '[') {
+		auto close = std::find(p, end, ']');
+		if (close == end || !parse_ip_literal(p + 1, close))
+			return false;
+		p = close + 1;
+	} else {
+		// reg-name, of which IPv4address is one
+		auto host = p;
+		while (p != end && *p != ':')
+			p++;
+		if (!encoded(host, p, unreserved | extra))
+			return false;
+	}
+
+	if (p == end)
+		return true;
+	if (*p++ != ':')
+		return false;
+	while (p != end && is(*p, digit))
+		p++;
+	return p == end;
 }
 
-} // namespace
+// URI, or URI-reference when relative-refs are allowed too - and likewise IRI and
+// IRI-reference by RFC 3987 with ucs_char as extra
+bool parse_uri(const char *p, const char *end, bool reference, std::uint16_t extra)
+{
+	// scheme ":"
+	auto scheme = p;
+	if (p != end && is(*p, alpha))
+		while (p != end && is(*p, scheme_char))
+			p++;
+	if (p != scheme && p != end && *p == ':')
+		p++;
+	else if (reference)
+		p = scheme; // relative-ref
+	else
+		return false;
+
+	// hier-part: "//" authority path-abempty, or path-absolute, path-rootless or
+	// path-empty, which are all made of path_chars - as is relative-part, but for
+	// path-noscheme not to have a ":" in its first segment
+	auto hier_part = p;
+	while (p != end && *p != '?' && *p != '#')
+		p++;
+	if (p - hier_part >= 2 && hier_part[0] == '/' && hier_part[1] == '/') {
+		auto path = std::find(hier_part + 2, p, '/');
+		if (!parse_authority(hier_part + 2, path, extra) || !encoded(path, p, path_char | extra))
+			return false;
+	} else {
+		auto segment = std::find(hier_part, p, '/');
+		if ((hier_part == scheme && std::find(hier_part, segment, ':') != segment) || !encoded(hier_part, p, path_char | extra))
+			return false;
+	}
 
-namespace nlohmann
+	// [ "?" query ] [ "#" fragment ]
+	if (p != end && *p == '?') {
+		auto query = ++p;
+		while (p != end && *p != '#')
+			p++;
+		if (!encoded(query, p, query_char | extra))
+			return false;
+	}
+	return p == end || encoded(p + 1, end, query_char | extra);
+}
+
+check_status rfc3986_uri_check(std::string_view value)
 {
-namespace json_schema
+	if (!parse_uri(value.data(), value.data() + value.size(), false, 0))
+		return {check_status::invalid, value, " is not a URI string according to RFC 3986."};
+	return {};
+}
+
+check_status rfc3986_uri_reference_check(std::string_view value)
+{
+	if (!parse_uri(value.data(), value.data() + value.size(), true, 0))
+		return {check_status::invalid, value, " is not a URI reference according to RFC 3986."};
+	return {};
+}
+
+check_status rfc3987_iri_check(std::string_view value)
 {
+	if (!parse_uri(value.data(), value.data() + value.size(), false, ucs_char))
+		return {check_status::invalid, value, " is not an IRI string according to RFC 3987."};
+	return {};
+}
+
+check_status rfc3987_iri_reference_check(std::string_view value)
+{
+	if (!parse_uri(value.data(), value.data() + value.size(), true, ucs_char))
+		return {check_status::invalid, value, " is not an IRI reference according to RFC 3987."};
+	return {};
+}
+
 /**
- * Checks validity for built-ins by converting the definitions given as ABNF in the linked RFC from
- * @see https://json-schema.org/understanding-json-schema/reference/string.html#built-in-formats
- * into regular expressions using @see https://www.msweet.org/abnf/ and some manual editing.
+ * @see https://tools.ietf.org/html/rfc6570#section-2
  *
- * @see https://json-schema.org/latest/json-schema-validation.html
+ * @verbatim
+ * URI-Template  = *( literals / expression )
+ * literals      =  %x21 / %x23-24 / %x26 / %x28-3B / %x3D / %x3F-5B
+ *               /  %x5D / %x5F / %x61-7A / %x7E / ucschar / iprivate
+ *               /  pct-encoded
+ * expression    =  "{" [ operator ] variable-list "}"
+ * operator      =  op-level2 / op-level3 / op-reserve
+ * op-level2     =  "+" / "#"
+ * op-level3     =  "." / "/" / ";" / "?" / "&"
+ * op-reserve    =  "=" / "," / "!" / "@" / "|"
+ * variable-list =  varspec *( "," varspec )
+ * varspec       =  varname [ modifier-level4 ]
+ * varname       =  varchar *( ["."] varchar )
+ * varchar       =  ALPHA / DIGIT / "_" / pct-encoded
+ * modifier-level4 =  prefix / explode
+ * prefix        =  ":" max-length
+ * max-length    =  %x31-39 0*3DIGIT   ; positive integer < 10000
+ * explode       =  "*"
+ * @endverbatim
  */
-void default_string_format_check(const std::string &format, const std::string &value)
+bool parse_variable_list(const char *p, const char *end)
 {
-	if (format == "date-time") {
-		rfc3339_date_time_check(value);
-	} else if (format == "date") {
-		rfc3339_date_check(value);
-	} else if (format == "time") {
-		rfc3339_time_check(value);
-	} else if (format == "uri") {
-		rfc3986_uri_check(value);
-	} else if (format == "email") {
-		if (!is_ascii(value)) {
-			throw std::invalid_argument(value + " contains non-ASCII values, not RFC 5321 compliant.");
-		}
-		if (!is_address(&*value.begin(), &*value.end())) {
-			throw std::invalid_argument(value + " is not a valid email according to RFC 5321.");
-		}
-	} else if (format == "idn-email") {
-		if (!is_address(&*value.begin(), &*value.end())) {
-			throw std::invalid_argument(value + " is not a valid idn-email according to RFC 6531.");
-		}
-	} else if (format == "hostname") {
-		static const REGEX_NAMESPACE::regex hostRegex{hostname};
-		if (!REGEX_NAMESPACE::regex_match(value, hostRegex)) {
-			throw std::invalid_argument(value + " is not a valid hostname according to RFC 3986 Appendix A.");
+	for (;;) {
+		auto name = p;
+		while (p != end) {
+			if (*p == '%') {
+				if (end - p < 3 || !is(p[1], hex_digit) || !is(p[2], hex_digit))
+					return false;
+				p += 3;
+			} else if (is(*p, alpha | digit) || *p == '_' || (*p == '.' && p != name && p[-1] != '.'))
+				p++;
+			else
+				break;
 		}
-	} else if (format == "ipv4") {
-		const static REGEX_NAMESPACE::regex ipv4Regex{"^" + ipv4Address + "$"};
-		if (!REGEX_NAMESPACE::regex_match(value, ipv4Regex)) {
-			throw std::invalid_argument(value + " is not an IPv4 string according to RFC 2673.");
-		}
-	} else if (format == "ipv6") {
-		static const REGEX_NAMESPACE::regex ipv6Regex{ipv6Address};
-		if (!REGEX_NAMESPACE::regex_match(value, ipv6Regex)) {
-			throw std::invalid_argument(value + " is not an IPv6 string according to RFC 5954.");
-		}
-	} else if (format == "uuid") {
-		static const REGEX_NAMESPACE::regex uuidRegex{uuid};
-		if (!REGEX_NAMESPACE::regex_match(value, uuidRegex)) {
-			throw std::invalid_argument(value + " is not an uuid string according to RFC 4122.");
+		if (p == name || p[-1] == '.')
+			return false;
+
+		if (p != end && *p == '*')
+			p++;
+		else if (p != end && *p == ':') {
+			auto length = ++p;
+			while (p != end && p - length < 4 && is(*p, digit))
+				p++;
+			if (p == length || *length == '0')
+				return false;
 		}
-	} else if (format == "regex") {
+
+		if (p == end)
+			return true;
+		if (*p++ != ',')
+			return false;
+	}
+}
+
+check_status rfc6570_uri_template_check(std::string_view value)
+{
+	static const char operators[] = "+#./;?&=,!@|";
+
+	const char *p = value.data(), *end = p + value.size();
+	bool valid = true;
+	while (valid && p != end) {
+		auto expression = std::find(p, end, '{');
+		valid = encoded(p, expression, literal_char);
+		if (!valid || expression == end)
+			break;
+
+		p = expression + 1;
+		auto close = std::find(p, end, '}');
+		if (p != close && std::find(operators, operators + sizeof(operators) - 1, *p) != operators + sizeof(operators) - 1)
+			p++;
+		valid = close != end && parse_variable_list(p, close);
+		p = close + 1;
+	}
+
+	if (!valid)
+		return {check_status::invalid, value, " is not a URI template according to RFC 6570."};
+	return {};
+}
+
+// *( "/" reference-token ), of which "~" is only escaping as "~0" or "~1"
+bool parse_json_pointer(const char *p, const char *end)
+{
+	if (p != end && *p != '/')
+		return false;
+	for (; p != end; p++)
+		if (*p == '~' && (end - p < 2 || (p[1] != '0' && p[1] != '1')))
+			return false;
+	return true;
+}
+
+check_status rfc6901_json_pointer_check(std::string_view value)
+{
+	if (!parse_json_pointer(value.data(), value.data() + value.size()))
+		return {check_status::invalid, value, " is not a JSON pointer according to RFC 6901."};
+	return {};
+}
+
+// non-negative-integer ( "#" / json-pointer )
+check_status relative_json_pointer_check(std::string_view value)
+{
+	const char *p = value.data(), *end = p + value.size();
+	auto number = p;
+	while (p != end && is(*p, digit))
+		p++;
+
+	if (p == number || (*number == '0' && p - number > 1) ||
+	    !(p != end && *p == '#' ? p + 1 == end : parse_json_pointer(p, end)))
+		return {check_status::invalid, value, " is not a relative JSON pointer according to draft-handrews-relative-json-pointer-01."};
+	return {};
+}
+
+check_status email_check(std::string_view value)
+{
+	if (!is_ascii(value))
+		return {check_status::invalid, value, " contains non-ASCII values, not RFC 5321 compliant."};
+	if (!is_address(value.data(), value.data() + value.size()))
+		return {check_status::invalid, value, " is not a valid email according to RFC 5321."};
+	return {};
+}
+
+check_status idn_email_check(std::string_view value)
+{
+	if (!is_address(value.data(), value.data() + value.size()))
+		return {check_status::invalid, value, " is not a valid idn-email according to RFC 6531."};
+	return {};
+}
+
+check_status hostname_check(std::string_view value)
+{
+	if (!parse_hostname(value))
+		return {check_status::invalid, value, " is not a valid hostname according to RFC 3986 Appendix A."};
+	return {};
+}
+
+check_status idn_hostname_check(std::string_view value)
+{
+	if (!nlohmann::json_schema::is_idn_hostname(value.data(), value.data() + value.size()))
+		return {check_status::invalid, value, " is not a valid idn-hostname according to RFC 5890."};
+	return {};
+}
+
+check_status ipv4_check(std::string_view value)
+{
+	if (!parse_ipv4(value.data(), value.data() + value.size(), false))
+		return {check_status::invalid, value, " is not an IPv4 string according to RFC 2673."};
+	return {};
+}
+
+check_status ipv6_check(std::string_view value)
+{
+	if (!parse_ipv6(value.data(), value.data() + value.size(), false))
+		return {check_status::invalid, value, " is not an IPv6 string according to RFC 5954."};
+	return {};
+}
+
+check_status uuid_check(std::string_view value)
+{
+	if (!parse_uuid(value))
+		return {check_status::invalid, value, " is not an uuid string according to RFC 4122."};
+	return {};
+}
+
+check_status regex_check(std::string_view view)
+{
+	// values repeat, whether they compile is remembered - by the error, empty if none
+	static nlohmann::json_schema::key_cache<std::string> checked(4096);
+	const std::string value(view);
+	const bool cached = value.size() <= 256;
+
+	std::string error;
+	if (!cached || !checked.find(value, error)) {
 		try {
-			REGEX_NAMESPACE::regex re(value, std::regex::ECMAScript);
+			REGEX_NAMESPACE::regex re(value, REGEX_NAMESPACE::regex::ECMAScript);
 		} catch (std::exception &exception) {
-			throw exception;
-		}
-	} else {
-		/* yet unsupported JSON schema draft 7 built-ins */
-		static const std::vector<std::string> jsonSchemaStringFormatBuiltIns{
-		    "date-time", "time", "date", "email", "idn-email", "hostname", "idn-hostname", "ipv4", "ipv6", "uri",
-		    "uri-reference", "iri", "iri-reference", "uri-template", "json-pointer", "relative-json-pointer", "regex"};
-		if (std::find(jsonSchemaStringFormatBuiltIns.begin(), jsonSchemaStringFormatBuiltIns.end(), format) != jsonSchemaStringFormatBuiltIns.end()) {
-			throw std::logic_error("JSON schema string format built-in " + format + " not yet supported. " +
-			                       "Please open an issue or use a custom format checker.");
+			error = value + " is not a valid regex: " + exception.what();
 		}
+		if (cached)
+			checked.insert(value, error);
+	}
+	if (!error.empty())
+		return {check_status::invalid, std::move(error)};
+	return {};
+}
+
+typedef check_status (*format_check)(std::string_view value);
 
-		throw std::logic_error("Don't know how to validate " + format);
+// the check of a supported format, null for any other
+format_check find_format(const std::string &format)
+{
+	static const std::pair<const char *, format_check> formats[] = {
+	    {"date-time", rfc3339_date_time_check},
+	    {"date", rfc3339_date_check},
+	    {"time", rfc3339_time_check},
+	    {"uri", rfc3986_uri_check},
+	    {"uri-reference", rfc3986_uri_reference_check},
+	    {"iri", rfc3987_iri_check},
+	    {"iri-reference", rfc3987_iri_reference_check},
+	    {"uri-template", rfc6570_uri_template_check},
+	    {"json-pointer", rfc6901_json_pointer_check},
+	    {"relative-json-pointer", relative_json_pointer_check},
+	    {"email", email_check},
+	    {"idn-email", idn_email_check},
+	    {"hostname", hostname_check},
+	    {"idn-hostname", idn_hostname_check},
+	    {"ipv4", ipv4_check},
+	    {"ipv6", ipv6_check},
+	    {"uuid", uuid_check},
+	    {"regex", regex_check},
+	};
+
+	for (auto &f : formats)
+		if (format == f.first)
+			return f.second;
+	return nullptr;
+}
+
+} // namespace
+
+namespace nlohmann
+{
+namespace json_schema
+{
+/**
+ * Checks validity for built-ins by scanning along the definitions given as ABNF in the linked RFCs of
+ * @see https://json-schema.org/understanding-json-schema/reference/string.html#built-in-formats
+ *
+ * @see https://json-schema.org/latest/json-schema-validation.html
+ */
+void default_string_format_check(const std::string &format, const std::string &value)
+{
+	auto check = find_format(format);
+	if (check) {
+		auto status = check(value);
+		if (!status.ok())
+			throw std::invalid_argument(status.message());
+		return;
 	}
+
+	throw std::logic_error("Don't know how to validate " + format);
+}
+
+format_value_checker default_string_format(const std::string &format)
+{
+	auto check = find_format(format);
+	if (!check)
+		return nullptr;
+	return check;
 }
 } // namespace json_schema
 } // namespace nlohmann
@@ -0,0 +1,207 @@
+#include <nlohmann/json-schema.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nlohmann
+{
+namespace json_schema
+{
+
+// Each thread of the pool has a queue of tasks. It takes its own tasks from the
+// back - the ones it has queued last - and steals those of the others from the
+// front. A thread waiting in parallel_for() executes tasks of any queue, so
+// calls nested in a task can neither starve nor deadlock the pool - while none
+// are queued it sleeps until the last task of its call signals it.
+struct thread_pool::impl {
+	struct job {
+		const std::function<void(std::size_t)> &task;
+		std::mutex mutex; // guards pending and error
+		std::condition_variable done;
+		std::size_t pending;
+		std::exception_ptr error;
+	};
+
+	struct task {
+		job *of;
+		std::size_t index;
+	};
+
+	struct queue {
+		std::mutex mutex;
+		std::deque<task> tasks;
+	};
+
+	static const std::size_t none = static_cast<std::size_t>(-1);
+
+	// the queue of the pool's thread running, none for other threads
+	static thread_local const impl *current_pool;
+	static thread_local std::size_t current_queue;
+
+	std::vector<std::unique_ptr<queue>> queues_;
+	std::vector<std::thread> threads_;
+
+	std::mutex sleep_mutex_;
+	std::condition_variable wake_;
+	std::atomic<std::size_t> queued_{0};
+	bool stop_ = false;
+
+	impl(std::size_t threads)
+	{
+		for (std::size_t i = 0; i < threads; i++)
+			queues_.emplace_back(new queue);
+		for (std::size_t i = 0; i < threads; i++)
+			threads_.emplace_back([this, i] { work(i); });
+	}
+
+	~impl()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex_);
+			stop_ = true;
+		}
+		wake_.notify_all();
+		for (auto &t : threads_)
+			t.join();
+	}
+
+	std::size_t own_queue() const
+	{
+		return current_pool == this ? current_queue : none;
+	}
+
+	bool take(queue &q, bool own, task &t)
+	{
+		std::lock_guard<std::mutex> lock(q.mutex);
+		if (q.tasks.empty())
+			return false;
+		if (own) {
+			t = q.tasks.back();
+			q.tasks.pop_back();
+		} else {
+			t = q.tasks.front();
+			q.tasks.pop_front();
+		}
+		queued_--;
+		return true;
+	}
+
+	bool find(std::size_t own, task &t)
+	{
+		if (own != none && take(*queues_[own], true, t))
+			return true;
+
+		auto first = own == none ? 0 : own + 1;
+		for (std::size_t i = 0; i < queues_.size(); i++)
+			if (take(*queues_[(first + i) % queues_.size()], false, t))
+				return true;
+		return false;
+	}
+
+	static void execute(const task &t)
+	{
+		std::exception_ptr error;
+		try {
+			t.of->task(t.index);
+		} catch (...) {
+			error = std::current_exception();
+		}
+
+		// the job is gone once its waiter has seen it done, which it does
+		// under the lock
+		std::lock_guard<std::mutex> lock(t.of->mutex);
+		if (error && !t.of->error)
+			t.of->error = error;
+		if (--t.of->pending == 0)
+			t.of->done.notify_one();
+	}
+
+	void work(std::size_t own)
+	{
+		current_pool = this;
+		current_queue = own;
+
+		for (;;) {
+			task t;
+			if (find(own, t)) {
+				execute(t);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(sleep_mutex_);
+			wake_.wait(lock, [this] { return stop_ || queued_ > 0; });
+			if (stop_ && queued_ == 0)
+				return;
+		}
+	}
+
+	void parallel_for(std::size_t n, const std::function<void(std::size_t)> &f)
+	{
+		job j{f, {}, {}, n, {}};
+
+		// queued on the own queue, where they are likely found again, or else spread
+		auto own = own_queue();
+		for (std::size_t i = 0; i < n; i++) {
+			auto &q = *queues_[own != none ? own : i % queues_.size()];
+			std::lock_guard<std::mutex> lock(q.mutex);
+			q.tasks.push_back({&j, i});
+			queued_++;
+		}
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex_);
+		}
+		wake_.notify_all();
+
+		for (;;) {
+			task t;
+			if (find(own, t)) {
+				execute(t);
+				continue;
+			}
+
+			// the remaining tasks run on other threads - woken when they are done,
+			// tasks queued meanwhile are looked for before sleeping
+			std::unique_lock<std::mutex> lock(j.mutex);
+			j.done.wait(lock, [&] { return j.pending == 0 || queued_ > 0; });
+			if (j.pending == 0)
+				break;
+		}
+
+		if (j.error)
+			std::rethrow_exception(j.error);
+	}
+};
+
+thread_local const thread_pool::impl *thread_pool::impl::current_pool = nullptr;
+thread_local std::size_t thread_pool::impl::current_queue = thread_pool::impl::none;
+
+thread_pool::thread_pool(std::size_t threads)
+    : impl_(new impl(threads ? threads : std::max(1u, std::thread::hardware_concurrency())))
+{
+}
+
+thread_pool::~thread_pool() = default;
+
+std::size_t thread_pool::size() const
+{
+	return impl_->threads_.size();
+}
+
+void thread_pool::parallel_for(std::size_t n, const std::function<void(std::size_t)> &task)
+{
+	if (n == 1) {
+		task(0);
+		return;
+	}
+	if (n > 1)
+		impl_->parallel_for(n, task);
+}
+
+} // namespace json_schema
+} // namespace nlohmann
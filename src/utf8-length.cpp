@@ -0,0 +1,144 @@
+#include "utf8-length.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	include <emmintrin.h>
+#	define UTF8_LENGTH_SSE2
+#endif
+
+// AVX2 is used where the CPU has it, also by builds not targeting it - only
+// GCC and clang compile single functions for it
+#if defined(__AVX2__)
+#	include <immintrin.h>
+#	define UTF8_LENGTH_AVX2
+#	define UTF8_LENGTH_TARGET_AVX2
+#elif defined(UTF8_LENGTH_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#	include <immintrin.h>
+#	define UTF8_LENGTH_AVX2
+#	define UTF8_LENGTH_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace nlohmann
+{
+namespace json_schema
+{
+
+namespace
+{
+
+// continuation bytes are 10xxxxxx, as signed chars those below -64; counts
+// of up to 255 vectors are summed in bytes before being widened
+
+#if defined(UTF8_LENGTH_AVX2)
+UTF8_LENGTH_TARGET_AVX2
+std::size_t count_continuation_bytes_avx2(const unsigned char *&p, const unsigned char *end)
+{
+	const __m256i threshold = _mm256_set1_epi8(-64);
+	std::size_t count = 0;
+	while (end - p >= 32) {
+		auto vectors = std::min<std::ptrdiff_t>((end - p) / 32, 255);
+		__m256i sums = _mm256_setzero_si256();
+		for (std::ptrdiff_t i = 0; i < vectors; i++, p += 32) {
+			__m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+			sums = _mm256_sub_epi8(sums, _mm256_cmpgt_epi8(threshold, bytes));
+		}
+
+		alignas(32) std::uint64_t lanes[4];
+		_mm256_store_si256(reinterpret_cast<__m256i *>(lanes), _mm256_sad_epu8(sums, _mm256_setzero_si256()));
+		count += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	}
+	return count;
+}
+#endif
+
+#if defined(UTF8_LENGTH_SSE2)
+std::size_t count_continuation_bytes_sse2(const unsigned char *&p, const unsigned char *end)
+{
+	const __m128i threshold = _mm_set1_epi8(-64);
+	std::size_t count = 0;
+	while (end - p >= 16) {
+		auto vectors = std::min<std::ptrdiff_t>((end - p) / 16, 255);
+		__m128i sums = _mm_setzero_si128();
+		for (std::ptrdiff_t i = 0; i < vectors; i++, p += 16) {
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+			sums = _mm_sub_epi8(sums, _mm_cmpgt_epi8(threshold, bytes));
+		}
+
+		alignas(16) std::uint64_t lanes[2];
+		_mm_store_si128(reinterpret_cast<__m128i *>(lanes), _mm_sad_epu8(sums, _mm_setzero_si128()));
+		count += lanes[0] + lanes[1];
+	}
+	return count;
+}
+#endif
+
+bool avx2_supported()
+{
+#if defined(__AVX2__)
+	return true;
+#elif defined(UTF8_LENGTH_AVX2)
+	static const bool supported = [] {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") != 0;
+	}();
+	return supported;
+#else
+	return false;
+#endif
+}
+
+utf8_counting fastest()
+{
+	if (avx2_supported())
+		return utf8_counting::avx2;
+	return utf8_counting_supported(utf8_counting::sse2) ? utf8_counting::sse2 : utf8_counting::scalar;
+}
+
+} // namespace
+
+bool utf8_counting_supported(utf8_counting how)
+{
+	switch (how) {
+	case utf8_counting::sse2:
+#if defined(UTF8_LENGTH_SSE2)
+		return true;
+#else
+		return false;
+#endif
+	case utf8_counting::avx2:
+		return avx2_supported();
+	default:
+		return true;
+	}
+}
+
+std::size_t utf8_length(const std::string &s, utf8_counting how)
+{
+	auto p = reinterpret_cast<const unsigned char *>(s.data());
+	auto end = p + s.size();
+
+	std::size_t continuation = 0;
+#if defined(UTF8_LENGTH_AVX2)
+	if (how == utf8_counting::avx2)
+		continuation = count_continuation_bytes_avx2(p, end);
+#endif
+#if defined(UTF8_LENGTH_SSE2)
+	if (how != utf8_counting::scalar) // after AVX2, fewer than 32 bytes are left
+		continuation += count_continuation_bytes_sse2(p, end);
+#endif
+	for (; p != end; ++p)
+		if ((*p & 0xc0) == 0x80)
+			continuation++;
+	return s.size() - continuation;
+}
+
+std::size_t utf8_length(const std::string &s)
+{
+	static const utf8_counting how = fastest();
+	return utf8_length(s, how);
+}
+
+} // namespace json_schema
+} // namespace nlohmann
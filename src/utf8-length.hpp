@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace nlohmann
+{
+namespace json_schema
+{
+
+// ways of counting code points, by byte or 16 or 32 bytes at a time
+enum class utf8_counting { scalar, sse2, avx2 };
+
+// whether the build and the CPU support counting so
+bool utf8_counting_supported(utf8_counting how);
+
+// number of code points of an UTF-8 string, as the number of bytes which are
+// not continuation bytes - counted the fastest supported way, or how, which
+// has to be supported
+std::size_t utf8_length(const std::string &s);
+std::size_t utf8_length(const std::string &s, utf8_counting how);
+
+// number of code points of s, counted once and only if the number of bytes
+// does not tell already - there are never more code points than bytes
+class string_length
+{
+	const std::string &s_;
+	std::size_t length_;
+	bool counted_ = false;
+
+	std::size_t get()
+	{
+		if (!counted_) {
+			length_ = utf8_length(s_);
+			counted_ = true;
+		}
+		return length_;
+	}
+
+public:
+	explicit string_length(const std::string &s)
+	    : s_(s) {}
+	explicit string_length(const std::string &&) = delete;
+
+	bool below(std::size_t min)
+	{
+		if (s_.size() < min)
+			return true;
+		return min > 0 && get() < min;
+	}
+
+	bool above(std::size_t max) { return s_.size() > max && get() > max; }
+};
+
+} // namespace json_schema
+} // namespace nlohmann
@@ -131,6 +131,18 @@ int main(void)
 				std::cout << "    Not yet implemented: " << e.what() << "\n";
 			}
 
+			// the fail-fast check has to come to the same conclusion
+			bool fail_fast_valid = false;
+			try {
+				fail_fast_valid = validator.is_valid(test_case["data"]);
+			} catch (const std::exception &e) {
+				std::cout << "    Fail-fast Test Case Exception: " << e.what() << "\n";
+			}
+			if (fail_fast_valid != valid) {
+				std::cout << "    is_valid() returned " << fail_fast_valid << " but validate() " << valid << "\n";
+				valid = !test_case["valid"]; /* force test-case failure */
+			}
+
 			if (valid == test_case["valid"])
 				std::cout << "      --> Test Case exited with " << valid << " as expected.\n";
 			else {
@@ -0,0 +1,158 @@
+#include <nlohmann/json-schema.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+using nlohmann::json;
+using nlohmann::json_schema::batch_mode;
+using nlohmann::json_schema::json_validator;
+using nlohmann::json_schema::thread_pool;
+
+namespace
+{
+
+static int error_count;
+
+#define EXPECT_EQ(a, b)                                              \
+	do {                                                             \
+		if (a != b) {                                                \
+			std::cerr << "Failed: '" << a << "' != '" << b << "'\n"; \
+			error_count++;                                           \
+		}                                                            \
+	} while (0)
+
+class collecting_handler : public nlohmann::json_schema::basic_error_handler
+{
+public:
+	std::vector<std::pair<std::string, std::string>> errors;
+
+	void error(const json::json_pointer &ptr, const json &instance, const std::string &message) override
+	{
+		basic_error_handler::error(ptr, instance, message);
+		errors.emplace_back(ptr.to_string(), message);
+	}
+};
+
+const json schema = R"({
+    "type": "object",
+    "properties": {
+        "id": {"type": "integer", "minimum": 0},
+        "name": {"type": "string", "format": "hostname"},
+        "tags": {"type": "array", "items": {"type": "string"}, "uniqueItems": true},
+        "flag": {"type": "boolean", "default": false}
+    },
+    "required": ["id"]
+})"_json;
+
+std::vector<json> documents(int n)
+{
+	std::vector<json> docs;
+	for (int i = 0; i < n; i++) {
+		json doc = {{"name", i % 5 == 0 ? "-bad" : "host"}, {"tags", {"a", i % 3 == 0 ? "a" : "b"}}};
+		if (i % 7)
+			doc["id"] = i % 11 == 0 ? -1 : i;
+		docs.push_back(doc);
+	}
+	return docs;
+}
+
+// the outcome of validating each document on its own
+void expect_results(const json_validator &validator, const std::vector<json> &docs, batch_mode mode, thread_pool *pool)
+{
+	auto results = validator.validate_batch(docs, mode, pool);
+	EXPECT_EQ(results.size(), docs.size());
+
+	for (std::size_t i = 0; i < docs.size(); i++) {
+		collecting_handler handler;
+		validator.validate(docs[i], handler);
+
+		EXPECT_EQ(results[i].valid, handler.errors.empty());
+		EXPECT_EQ(results[i].valid, validator.is_valid(docs[i]));
+		if (mode == batch_mode::fail_fast) {
+			EXPECT_EQ(results[i].errors, (handler.errors.empty() ? 0 : 1));
+			EXPECT_EQ(results[i].first_error, "");
+		} else {
+			EXPECT_EQ(results[i].errors, handler.errors.size());
+			if (!handler.errors.empty()) {
+				EXPECT_EQ(results[i].first_error_ptr.to_string(), handler.errors[0].first);
+				EXPECT_EQ(results[i].first_error, handler.errors[0].second);
+			}
+		}
+	}
+}
+
+} // namespace
+
+int main(void)
+{
+	json_validator validator(nullptr, nlohmann::json_schema::default_string_format_check);
+	validator.cache_format("hostname");
+	validator.set_root_schema(schema);
+
+	const auto docs = documents(1000);
+	thread_pool pool(3);
+
+	for (auto mode : {batch_mode::fail_fast, batch_mode::all_errors}) {
+		expect_results(validator, docs, mode, &pool);           // an injected pool
+		expect_results(validator, docs, mode, nullptr);         // threads of the call
+		expect_results(validator, documents(1), mode, nullptr); // on the calling thread
+		expect_results(validator, {}, mode, &pool);
+	}
+
+	// on the pool of set_parallel(), also validating the documents' arrays
+	validator.set_parallel(1);
+	expect_results(validator, docs, batch_mode::all_errors, nullptr);
+	validator.set_parallel(0);
+
+	// without a pool, the one of the validator is kept across calls: no more
+	// threads than it has and the calling one ever check a value
+	static std::atomic<unsigned> threads{0};
+	json_validator counting(
+	    R"({"format": "slow"})"_json,
+	    nullptr,
+	    [](const std::string &, const std::string &) {
+		    static thread_local bool seen = false;
+		    if (!seen) {
+			    seen = true;
+			    threads++;
+		    }
+		    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	    });
+	std::vector<json> values(50, "value");
+	for (int i = 0; i < 10; i++)
+		counting.validate_batch(values);
+	bool kept = threads <= std::max(1u, std::thread::hardware_concurrency()) + 1;
+	EXPECT_EQ(kept, true);
+
+	// the first exception of a checker is rethrown
+	json_validator throwing(
+	    R"({"format": "odd"})"_json,
+	    nullptr,
+	    [](const std::string &, const std::string &value) {
+		    if (value == "boom")
+			    throw 42; // not turned into a format-error
+	    });
+	std::vector<json> strings(100, "fine");
+	strings[50] = "boom";
+	bool thrown = false;
+	try {
+		throwing.validate_batch(strings, batch_mode::fail_fast, &pool);
+	} catch (int) {
+		thrown = true;
+	}
+	EXPECT_EQ(thrown, true);
+
+	// results written to a caller's array
+	nlohmann::json_schema::batch_result results[3];
+	const json three[] = {R"({"id": 1})"_json, R"({})"_json, R"({"id": "a"})"_json};
+	validator.validate_batch(three, 3, results, batch_mode::all_errors, &pool);
+	EXPECT_EQ(results[0].valid, true);
+	EXPECT_EQ(results[1].valid, false);
+	EXPECT_EQ(results[2].first_error_ptr.to_string(), "/id");
+
+	return error_count;
+}
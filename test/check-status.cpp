@@ -0,0 +1,111 @@
+#include <nlohmann/json-schema.hpp>
+
+#include <iostream>
+
+using nlohmann::json;
+using nlohmann::json_schema::check_status;
+using nlohmann::json_schema::format_value_checker;
+using nlohmann::json_schema::json_validator;
+
+namespace
+{
+
+static int error_count;
+
+#define EXPECT_EQ(a, b)                                              \
+	do {                                                             \
+		if (a != b) {                                                \
+			std::cerr << "Failed: '" << a << "' != '" << b << "'\n"; \
+			error_count++;                                           \
+		}                                                            \
+	} while (0)
+
+const json schema = R"({
+    "properties": {
+        "name": {"type": "string", "format": "lowercase"},
+        "data": {"contentEncoding": "base64", "contentMediaType": "text/plain"}
+    }
+})"_json;
+
+int messages_built;
+
+check_status lowercase(std::string_view value)
+{
+	if (value.find_first_of("ABCDEFGHIJKLMNOPQRSTUVWXYZ") == std::string_view::npos)
+		return {};
+	return {check_status::invalid, [value] {
+		        messages_built++;
+		        return std::string(value) + " is not lowercase";
+	        }};
+}
+
+check_status plain_text(std::string_view encoding, std::string_view media_type, const json &)
+{
+	if (encoding == "base64" && media_type == "text/plain")
+		return {};
+	return {check_status::invalid, "unexpected content"};
+}
+
+class collect : public nlohmann::json_schema::basic_error_handler
+{
+public:
+	std::vector<std::string> messages;
+
+	void error(const json::json_pointer &ptr, const json &instance, const std::string &message) override
+	{
+		basic_error_handler::error(ptr, instance, message);
+		messages.push_back(message);
+	}
+};
+
+} // namespace
+
+int main(void)
+{
+	json_validator validator(nullptr, nullptr, plain_text);
+	validator.add_format("lowercase", lowercase);
+	validator.set_root_schema(schema);
+
+	EXPECT_EQ(validator.is_valid(R"({"name": "Name"})"_json), false);
+	EXPECT_EQ(validator.is_valid(R"({"name": "name", "data": "c29tZQ=="})"_json), true);
+	EXPECT_EQ(validator.is_valid(R"({"data": "c29tZQ=="})"_json), true);
+
+	// the message is built when the error is reported
+	collect errors;
+	messages_built = 0;
+	validator.validate(R"({"name": "Name"})"_json, errors);
+	EXPECT_EQ(messages_built, 1);
+	EXPECT_EQ(errors.messages.size(), 1);
+	EXPECT_EQ(errors.messages[0], "format-checking failed: Name is not lowercase");
+
+	// the throwing interface on top of a status-returning check and vice versa
+	format_value_checker status_check = lowercase;
+	bool thrown = false;
+	try {
+		status_check(std::string("Name"));
+	} catch (const std::invalid_argument &e) {
+		thrown = e.what() == std::string("Name is not lowercase");
+	}
+	EXPECT_EQ(thrown, true);
+
+	format_value_checker throwing_check = [](const std::string &value) {
+		if (value.empty())
+			throw std::invalid_argument("empty");
+	};
+	auto status = throwing_check.check("");
+	EXPECT_EQ(status.ok(), false);
+	EXPECT_EQ(status.code(), check_status::thrown);
+	EXPECT_EQ(status.message(), "empty");
+	EXPECT_EQ(throwing_check.check("x").ok(), true);
+
+	// built-in checks, their messages as when they threw
+	auto date = nlohmann::json_schema::default_string_format("date");
+	const std::string no_date = "2019-02-xx", out_of_range = "2019-02-30";
+	EXPECT_EQ(date.check(no_date).code(), check_status::invalid);
+	EXPECT_EQ(date.check(no_date).message(), "2019-02-xx is not a date string according to RFC 3339.");
+	EXPECT_EQ(date.check(out_of_range).code(), check_status::out_of_range);
+	EXPECT_EQ(date.check(out_of_range).message(), "Value 30 should be in interval [1,28] but is not!");
+	EXPECT_EQ(date.check("2019-02-28").ok(), true);
+
+	return error_count;
+}
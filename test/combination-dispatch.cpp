@@ -0,0 +1,118 @@
+#include <nlohmann/json-schema.hpp>
+
+#include <iostream>
+
+using nlohmann::json;
+using nlohmann::json_schema::json_validator;
+
+namespace
+{
+
+static int error_count;
+
+#define EXPECT_EQ(a, b)                                              \
+	do {                                                             \
+		if (a != b) {                                                \
+			std::cerr << "Failed: '" << a << "' != '" << b << "'\n"; \
+			error_count++;                                           \
+		}                                                            \
+	} while (0)
+
+// each case checks its payload with a format counting the cases which were run
+const json schema = R"({
+    "definitions": {
+        "event": {
+            "type": "object",
+            "required": ["type"],
+            "properties": {"payload": {"format": "counted"}}
+        }
+    },
+    "oneOf": [
+        {"allOf": [{"$ref": "#/definitions/event"}, {"properties": {"type": {"const": "created"}, "id": {"type": "integer"}}}]},
+        {"allOf": [{"$ref": "#/definitions/event"}, {"properties": {"type": {"const": "deleted"}, "id": {"type": "integer"}}}]},
+        {"allOf": [{"$ref": "#/definitions/event"}, {"properties": {"type": {"enum": ["renamed", "moved"]}, "to": {"default": "/"}}}]},
+        {"type": "string", "format": "counted"},
+        {"type": "array", "items": {"format": "counted"}}
+    ]
+})"_json;
+
+int cases_run;
+
+void counted(const std::string &)
+{
+	cases_run++;
+}
+
+class collect : public nlohmann::json_schema::basic_error_handler
+{
+public:
+	std::vector<std::string> messages;
+
+	void error(const json::json_pointer &ptr, const json &instance, const std::string &message) override
+	{
+		basic_error_handler::error(ptr, instance, message);
+		messages.push_back(ptr.to_string() + ": " + message);
+	}
+};
+
+bool run_cases(const json_validator &validator, const json &document, int expected_cases)
+{
+	cases_run = 0;
+	bool valid = validator.is_valid(document);
+	EXPECT_EQ(cases_run, expected_cases);
+
+	cases_run = 0;
+	collect errors;
+	validator.validate(document, errors);
+	EXPECT_EQ(bool(errors), !valid);
+	if (valid)
+		EXPECT_EQ(cases_run, expected_cases);
+	return valid;
+}
+
+} // namespace
+
+int main(void)
+{
+	json_validator validator;
+	validator.add_format("counted", counted);
+	validator.set_root_schema(schema);
+
+	// the discriminating property selects the only case which can succeed
+	EXPECT_EQ(run_cases(validator, R"({"type": "created", "id": 1, "payload": "x"})"_json, 1), true);
+	EXPECT_EQ(run_cases(validator, R"({"type": "deleted", "id": 1, "payload": "x"})"_json, 1), true);
+	EXPECT_EQ(run_cases(validator, R"({"type": "moved", "payload": "x"})"_json, 1), true);
+	EXPECT_EQ(run_cases(validator, R"({"type": "created", "id": "1", "payload": "x"})"_json, 1), false);
+
+	// an unknown or missing value leaves no case to run
+	EXPECT_EQ(run_cases(validator, R"({"type": "copied", "payload": "x"})"_json, 0), false);
+	EXPECT_EQ(run_cases(validator, R"({"type": 1, "payload": "x"})"_json, 0), false);
+	EXPECT_EQ(run_cases(validator, R"({"payload": "x"})"_json, 0), false);
+
+	// other types only run the cases allowing them
+	EXPECT_EQ(run_cases(validator, "x", 1), true);
+	EXPECT_EQ(run_cases(validator, R"(["x", "y"])"_json, 2), true);
+	EXPECT_EQ(run_cases(validator, 1, 0), false);
+
+	// defaults of the selected case are still added
+	auto patch = validator.validate(R"({"type": "renamed"})"_json);
+	EXPECT_EQ(patch, R"([{"op": "add", "path": "/to", "value": "/"}])"_json);
+
+	// when no case succeeds, the errors of all of them are reported
+	collect errors;
+	validator.validate(R"({"type": "created", "id": "1"})"_json, errors);
+	EXPECT_EQ(errors.messages.size(), 10);
+	EXPECT_EQ(errors.messages.front(), ": no subschema has succeeded, but one of them is required to validate. Type: oneOf, number of failed subschemas: 5");
+
+	// several matching cases fail a oneOf
+	json_validator both;
+	both.set_root_schema(R"({"oneOf": [{"properties": {"kind": {"const": "a"}}}, {"properties": {"kind": {"enum": ["a", "b"]}}}, {"type": "string"}]})"_json);
+	EXPECT_EQ(both.is_valid(R"({"kind": "a"})"_json), false);
+	EXPECT_EQ(both.is_valid(R"({"kind": "b"})"_json), true);
+	errors = collect();
+	both.validate(R"({"kind": "a"})"_json, errors);
+	EXPECT_EQ(errors.messages.size(), 1);
+	EXPECT_EQ(errors.messages.front(), ": more than one subschema has succeeded, but exactly one of them is required to validate");
+
+	return error_count;
+}
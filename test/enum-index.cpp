@@ -0,0 +1,58 @@
+#include <nlohmann/json-schema.hpp>
+
+#include <iostream>
+
+using nlohmann::json;
+using nlohmann::json_schema::json_validator;
+
+namespace
+{
+
+static int error_count;
+
+#define EXPECT_EQ(a, b)                                              \
+	do {                                                             \
+		if (a != b) {                                                \
+			std::cerr << "Failed: '" << a << "' != '" << b << "'\n"; \
+			error_count++;                                           \
+		}                                                            \
+	} while (0)
+
+} // namespace
+
+int main(void)
+{
+	// enough values to be looked up by their hash
+	json values = json::array();
+	for (int i = 0; i < 1000; i++)
+		values.push_back("code-" + std::to_string(i));
+	values.push_back(7);
+	values.push_back(2.5);
+	values.push_back(nullptr);
+	values.push_back({{"a", {1, 2}}});
+
+	json_validator validator(json{{"enum", values}});
+
+	EXPECT_EQ(validator.is_valid("code-0"), true);
+	EXPECT_EQ(validator.is_valid("code-999"), true);
+	EXPECT_EQ(validator.is_valid("code-1000"), false);
+	EXPECT_EQ(validator.is_valid(7), true);
+	EXPECT_EQ(validator.is_valid(7.0), true);
+	EXPECT_EQ(validator.is_valid(2.5), true);
+	EXPECT_EQ(validator.is_valid(8), false);
+	EXPECT_EQ(validator.is_valid(nullptr), true);
+	EXPECT_EQ(validator.is_valid(R"({"a": [1.0, 2]})"_json), true);
+	EXPECT_EQ(validator.is_valid(R"({"a": [2, 1]})"_json), false);
+	EXPECT_EQ(validator.is_valid(true), false);
+	EXPECT_EQ(validator.is_valid(json::array()), false);
+
+	// few values are compared one after the other
+	json_validator small(R"({"enum": ["a", 1, [1]]})"_json);
+	EXPECT_EQ(small.is_valid("a"), true);
+	EXPECT_EQ(small.is_valid(1.0), true);
+	EXPECT_EQ(small.is_valid(json::array({1})), true);
+	EXPECT_EQ(small.is_valid("b"), false);
+	EXPECT_EQ(small.is_valid(false), false);
+
+	return error_count;
+}
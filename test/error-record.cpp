@@ -0,0 +1,111 @@
+#include <nlohmann/json-schema.hpp>
+
+#include <iostream>
+
+using nlohmann::json;
+using nlohmann::json_schema::error_code;
+using nlohmann::json_schema::error_record;
+using nlohmann::json_schema::json_validator;
+
+namespace
+{
+
+static int error_count;
+
+#define EXPECT_EQ(a, b)                                              \
+	do {                                                             \
+		if (a != b) {                                                \
+			std::cerr << "Failed: '" << a << "' != '" << b << "'\n"; \
+			error_count++;                                           \
+		}                                                            \
+	} while (0)
+
+static json schema = R"(
+{
+    "properties": {
+        "age": {
+            "type": "integer",
+            "maximum": 200
+        },
+        "name": {
+            "anyOf": [
+                { "type": "string", "maxLength": 3 },
+                { "type": "integer" }
+            ]
+        }
+    },
+    "required": ["name"]
+})"_json;
+
+// keeps the codes, limits and messages of all errors
+class record_handler : public nlohmann::json_schema::basic_error_handler
+{
+public:
+	struct entry {
+		error_code code;
+		std::string ptr;
+		std::string location;
+		json limit;
+		std::string message;
+	};
+	std::vector<entry> entries;
+
+	void error(const error_record &record) override
+	{
+		basic_error_handler::error(record.ptr(), record.instance(), "");
+		entries.push_back({record.code(), record.ptr().to_string(), record.schema_location(),
+		                   record.limit() ? *record.limit() : json(), record.message()});
+	}
+};
+
+// receives the messages of error_records through the default adapter
+class message_handler : public nlohmann::json_schema::basic_error_handler
+{
+public:
+	std::vector<std::string> messages;
+
+	void error(const json::json_pointer &ptr, const json &instance, const std::string &message) override
+	{
+		basic_error_handler::error(ptr, instance, message);
+		messages.push_back(message);
+	}
+};
+
+} // namespace
+
+int main(void)
+{
+	json_validator validator(schema);
+
+	record_handler records;
+	validator.validate({{"age", 201}}, records);
+	EXPECT_EQ(records.entries.size(), 2);
+	EXPECT_EQ((int) records.entries[0].code, (int) error_code::required);
+	EXPECT_EQ(records.entries[0].message, "required property 'name' not found in object");
+	EXPECT_EQ((int) records.entries[1].code, (int) error_code::maximum);
+	EXPECT_EQ(records.entries[1].ptr, "/age");
+	EXPECT_EQ(records.entries[1].location, "#/properties/age");
+	EXPECT_EQ(records.entries[1].limit, 200);
+	EXPECT_EQ(records.entries[1].message, "instance exceeds maximum of 200");
+
+	// errors of failed anyOf-cases are reported with their case
+	records.entries.clear();
+	validator.validate({{"name", "long"}}, records);
+	EXPECT_EQ(records.entries.size(), 3);
+	EXPECT_EQ((int) records.entries[0].code, (int) error_code::any_of);
+	EXPECT_EQ(records.entries[0].limit, 2);
+	EXPECT_EQ((int) records.entries[1].code, (int) error_code::max_length);
+	EXPECT_EQ(records.entries[1].ptr, "/name");
+	EXPECT_EQ(records.entries[1].location, "#/properties/name/anyOf/0");
+	EXPECT_EQ(records.entries[1].message, "[combination: anyOf / case#0] instance is too long as per maxLength: 3");
+	EXPECT_EQ((int) records.entries[2].code, (int) error_code::unexpected_type);
+
+	// handlers only implementing the string-callback get the same messages
+	message_handler messages;
+	validator.validate({{"name", "long"}}, messages);
+	EXPECT_EQ(messages.messages.size(), records.entries.size());
+	for (size_t i = 0; i < messages.messages.size() && i < records.entries.size(); i++)
+		EXPECT_EQ(messages.messages[i], records.entries[i].message);
+
+	return error_count;
+}
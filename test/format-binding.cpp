@@ -0,0 +1,102 @@
+#include <nlohmann/json-schema.hpp>
+
+#include <iostream>
+
+using nlohmann::json;
+using nlohmann::json_schema::json_validator;
+
+namespace
+{
+
+static int error_count;
+
+#define EXPECT_EQ(a, b)                                              \
+	do {                                                             \
+		if (a != b) {                                                \
+			std::cerr << "Failed: '" << a << "' != '" << b << "'\n"; \
+			error_count++;                                           \
+		}                                                            \
+	} while (0)
+
+const json schema = R"({
+    "properties": {
+        "even": {"format": "even-length"},
+        "date": {"format": "date"},
+        "other": {"format": "other"}
+    }
+})"_json;
+
+int catch_all_calls;
+
+void catch_all(const std::string &format, const std::string &value)
+{
+	catch_all_calls++;
+	if (format != "other")
+		throw std::logic_error("Don't know how to validate " + format);
+	if (value != "other")
+		throw std::invalid_argument("not other");
+}
+
+void even_length(std::string_view value)
+{
+	if (value.size() % 2)
+		throw std::invalid_argument("odd length");
+}
+
+bool valid(const json_validator &validator, const json &document)
+{
+	try {
+		validator.validate(document);
+	} catch (const std::exception &) {
+		return false;
+	}
+	return true;
+}
+
+} // namespace
+
+int main(void)
+{
+	// an added format, without any format_checker
+	json_validator added;
+	added.add_format("even-length", even_length);
+	added.set_root_schema(R"({"format": "even-length"})"_json);
+	EXPECT_EQ(valid(added, "ab"), true);
+	EXPECT_EQ(valid(added, "abc"), false);
+
+	// the format_checker is called for the formats which were not added
+	json_validator both(nullptr, catch_all);
+	both.add_format("even-length", even_length);
+	both.add_format("date", [](const std::string &) { throw std::invalid_argument("no dates"); });
+	both.set_root_schema(schema);
+
+	catch_all_calls = 0;
+	EXPECT_EQ(valid(both, R"({"even": "ab", "other": "other"})"_json), true);
+	EXPECT_EQ(catch_all_calls, 1);
+	EXPECT_EQ(valid(both, R"({"even": "abc"})"_json), false);
+	EXPECT_EQ(valid(both, R"({"other": "different"})"_json), false);
+	EXPECT_EQ(valid(both, R"({"date": "2019-07-04"})"_json), false);
+
+	// formats of the default checker are bound to their check, unknown ones are
+	// reported when validated as before
+	json_validator defaults(nullptr, nlohmann::json_schema::default_string_format_check);
+	defaults.set_root_schema(R"({"properties": {"date": {"format": "date"}, "other": {"format": "other"}}})"_json);
+	EXPECT_EQ(valid(defaults, R"({"date": "2019-07-04"})"_json), true);
+	EXPECT_EQ(valid(defaults, R"({"date": "2019-07-44"})"_json), false);
+	EXPECT_EQ(valid(defaults, R"({"other": "value"})"_json), false);
+
+	EXPECT_EQ((nlohmann::json_schema::default_string_format("ipv4") != nullptr), true);
+	EXPECT_EQ((nlohmann::json_schema::default_string_format("other") == nullptr), true);
+
+	// without a check for a format the schema is refused
+	json_validator none;
+	bool refused = false;
+	try {
+		none.set_root_schema(R"({"format": "even-length"})"_json);
+	} catch (const std::invalid_argument &) {
+		refused = true;
+	}
+	EXPECT_EQ(refused, true);
+
+	return error_count;
+}
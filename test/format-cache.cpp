@@ -0,0 +1,125 @@
+#include <nlohmann/json-schema.hpp>
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using nlohmann::json;
+using nlohmann::json_schema::check_status;
+using nlohmann::json_schema::json_validator;
+
+namespace
+{
+
+static int error_count;
+
+#define EXPECT_EQ(a, b)                                              \
+	do {                                                             \
+		if (a != b) {                                                \
+			std::cerr << "Failed: '" << a << "' != '" << b << "'\n"; \
+			error_count++;                                           \
+		}                                                            \
+	} while (0)
+
+std::atomic<int> checks;
+
+check_status even_length(std::string_view value)
+{
+	checks++;
+	if (value.size() % 2 == 0)
+		return {};
+	return {check_status::invalid, value, " has an odd length"};
+}
+
+class collect : public nlohmann::json_schema::basic_error_handler
+{
+public:
+	std::vector<std::string> messages;
+
+	void error(const json::json_pointer &ptr, const json &instance, const std::string &message) override
+	{
+		basic_error_handler::error(ptr, instance, message);
+		messages.push_back(message);
+	}
+};
+
+json_validator cached_validator(std::size_t entries)
+{
+	json_validator validator;
+	validator.add_format("even", even_length);
+	validator.add_format("other", even_length);
+	validator.cache_format("even");
+	validator.set_format_cache_size(entries);
+	validator.set_root_schema(R"({"properties": {"even": {"format": "even"}, "other": {"format": "other"}}})"_json);
+	return validator;
+}
+
+} // namespace
+
+int main(void)
+{
+	auto validator = cached_validator(1024);
+
+	// checked once, then remembered - a remembered failure may be checked again
+	// to build its message
+	checks = 0;
+	for (int i = 0; i < 10; i++) {
+		EXPECT_EQ(validator.is_valid(R"({"even": "ab"})"_json), true);
+		EXPECT_EQ(validator.is_valid(R"({"even": "abc"})"_json), false);
+	}
+	EXPECT_EQ((checks >= 2), true);
+	checks = 0;
+	for (int i = 0; i < 10; i++)
+		EXPECT_EQ(validator.is_valid(R"({"even": "ab"})"_json), true);
+	EXPECT_EQ(checks, 0);
+	EXPECT_EQ(validator.cache_stats("even").hits, 28);
+	EXPECT_EQ(validator.cache_stats("even").misses, 2);
+
+	// only cached formats are cached
+	checks = 0;
+	for (int i = 0; i < 10; i++)
+		EXPECT_EQ(validator.is_valid(R"({"other": "ab"})"_json), true);
+	EXPECT_EQ(checks, 10);
+	EXPECT_EQ(validator.cache_stats("other").hits, 0);
+
+	// a remembered failure is reported with its message
+	collect errors;
+	validator.validate(R"({"even": "abc"})"_json, errors);
+	EXPECT_EQ(errors.messages.size(), 1);
+	EXPECT_EQ(errors.messages[0], "format-checking failed: abc has an odd length");
+
+	// long values are checked each time
+	json long_value = {{"even", std::string(100, 'x')}};
+	checks = 0;
+	EXPECT_EQ(validator.is_valid(long_value), true);
+	EXPECT_EQ(validator.is_valid(long_value), true);
+	EXPECT_EQ(checks, 2);
+
+	// values are replaced in a small cache, each outcome stays right - also
+	// while threads look up and replace them at the same time
+	auto small = cached_validator(16);
+	std::vector<json> documents;
+	for (int i = 0; i < 200; i++)
+		documents.push_back({{"even", std::string(i % 60, 'a' + i % 26)}});
+
+	std::atomic<int> wrong{0};
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; t++)
+		threads.emplace_back([&, t] {
+			for (int i = 0; i < 20000; i++) {
+				auto &document = documents[(i * 7 + t * 13) % documents.size()];
+				bool expected = document["even"].get_ref<const std::string &>().size() % 2 == 0;
+				if (small.is_valid(document) != expected)
+					wrong++;
+			}
+		});
+	for (auto &thread : threads)
+		thread.join();
+	EXPECT_EQ(wrong, 0);
+
+	auto stats = small.cache_stats("even");
+	EXPECT_EQ(stats.hits + stats.misses, 80000);
+
+	return error_count;
+}
@@ -0,0 +1,80 @@
+#include <nlohmann/json-schema.hpp>
+
+#include <iostream>
+
+using nlohmann::json;
+using nlohmann::json_schema::json_validator;
+
+namespace
+{
+
+class store_all_errors : public nlohmann::json_schema::basic_error_handler
+{
+public:
+	std::vector<std::string> messages;
+
+	void error(const json::json_pointer &ptr, const json &instance, const std::string &message) override
+	{
+		nlohmann::json_schema::basic_error_handler::error(ptr, instance, message);
+		messages.push_back(ptr.to_string() + ": " + message);
+	}
+};
+
+int failed = 0;
+
+void expect(bool ok, const std::string &what)
+{
+	if (!ok) {
+		std::cerr << "FAILED: " << what << "\n";
+		failed++;
+	}
+}
+
+} // namespace
+
+int main()
+{
+	json_validator validator;
+
+	// the schema is kept even though setting it throws - as the example-program
+	// does, validating afterwards has to report the reference, not crash
+	try {
+		validator.set_root_schema(json::parse(R"({"properties": {"a": {"$ref": "#/definitions/missing"}}})"));
+		expect(false, "set_root_schema() did not throw for an undefined reference");
+	} catch (const std::invalid_argument &) {
+	}
+
+	store_all_errors e;
+	validator.validate(json{{"a", 1}}, e);
+	expect(e.messages.size() == 1, "one error for the unresolved reference");
+	for (auto &m : e.messages)
+		expect(m == "/a: unresolved or freed schema-reference  # /definitions/missing",
+		       "error names the unresolved reference: " + m);
+
+	expect(!validator.is_valid(json{{"a", 1}}), "is_valid() fails on the unresolved reference");
+
+	// absent, the reference is still reported - asked for its default value
+	store_all_errors absent;
+	validator.validate(json{{"b", 1}}, absent);
+	expect(absent.messages.size() == 1, "one error for the default value of the unresolved reference");
+	for (auto &m : absent.messages)
+		expect(m == ": unresolved or freed schema-reference  # /definitions/missing",
+		       "error names the unresolved reference: " + m);
+	expect(!validator.is_valid(json{{"b", 1}}), "is_valid() fails on the default value of the unresolved reference");
+
+	// a failing loader leaves the schema without a compiled program
+	json_validator loading([](const nlohmann::json_uri &, json &) { throw std::runtime_error("not found"); });
+	try {
+		loading.set_root_schema(json::parse(R"({"$ref": "http://example.com/remote.json"})"));
+		expect(false, "set_root_schema() did not throw for a failing loader");
+	} catch (const std::runtime_error &) {
+	}
+
+	expect(!loading.is_valid(json{{"a", 1}}), "is_valid() fails without a program");
+
+	store_all_errors loading_errors;
+	loading.validate(json{{"a", 1}}, loading_errors);
+	expect(loading_errors.messages.size() == 1, "validate() reports the missing program");
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
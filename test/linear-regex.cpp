@@ -0,0 +1,180 @@
+#include "linear-regex.hpp"
+
+#include <nlohmann/json-schema.hpp>
+
+#include <iostream>
+#include <regex>
+
+using nlohmann::json;
+using nlohmann::json_schema::linear_regex;
+using nlohmann::json_schema::regex_unsupported;
+
+namespace
+{
+
+static int error_count;
+
+#define EXPECT_EQ(a, b)                                              \
+	do {                                                             \
+		if (a != b) {                                                \
+			std::cerr << "Failed: '" << a << "' != '" << b << "'\n"; \
+			error_count++;                                           \
+		}                                                            \
+	} while (0)
+
+void expect_same_as_std(const std::string &pattern, const std::vector<std::string> &subjects)
+{
+	linear_regex linear(pattern);
+	std::regex reference(pattern, std::regex::ECMAScript);
+	for (auto &subject : subjects)
+		if (linear.search(subject) != std::regex_search(subject, reference)) {
+			std::cerr << "Failed: /" << pattern << "/ on '" << subject << "'\n";
+			error_count++;
+		}
+}
+
+bool unsupported(const std::string &pattern)
+{
+	try {
+		linear_regex r(pattern);
+	} catch (const regex_unsupported &) {
+		return true;
+	}
+	return false;
+}
+
+} // namespace
+
+int main(void)
+{
+	const std::vector<std::string> subjects{
+	    "", "a", "ab", "abc", "aab", "ba", "abcabc", "xyz", "a-b", "a_b", "a b",
+	    "123", "12ab34", "2019-07-04", "foo@bar.com", "\t", "a\nb", "AB", "zz9",
+	    "hello world", "aaaaaaaa", "-", "..."};
+
+	for (auto &pattern : {"a", "^a", "a$", "^a$", "^$", "ab|c", "^(ab|c)+$", "a*", "^a*$", "a+b",
+	                      "^a?b", "a{2}", "^a{2,}$", "^a{1,3}b", "[abc]", "[^abc]", "^[a-c]+$",
+	                      "[-a]", "[a-]", "\\d+", "^\\d{4}-\\d{2}-\\d{2}$", "\\D", "\\w+@\\w+\\.com",
+	                      "\\W", "\\s", "\\S+", ".", "^.+$", "a.b", "\\.", "[.]", "(?:ab)+",
+	                      "^(a|ab)(c|bcd)?$", "\\bworld", "o\\b", "\\Bb", "^\\b", "\\t", "[\\d-]+",
+	                      "[\\]]", "\\x61", "\\u0062", "(a*)*b", "^(a+)+$", "^()$", "a|", "|b",
+	                      "^[^\\s]*$", "[\\b]", "z{0}", "^.{3}$", "\\/"})
+		expect_same_as_std(pattern, subjects);
+
+	// trivial shapes checked by dedicated scanners
+	const std::vector<std::string> shaped_subjects{
+	    "", "a", "abc", "prefix-", "prefix-a", "a-prefix-", "PREFIX-", "x.json", ".json", "x.jsonx",
+	    "ABC", "AB", "ABCD", "aBC", "a_0", "a b", "Z9_", "\xc3\xa9", "a\xc3\xa9", "\xc3\xa9t\xc3\xa9",
+	    "\xff", "a\xffz", "a\nb", "\xe2\x82\xac"};
+	for (auto &pattern : {"^[a-z0-9_]+$", "^prefix-", "\\.json$", "^[A-Z]{3}$", "abc", "^abc$", "^$", "",
+	                      "^", "$", "^[a-z]*$", "^[A-Z]{2,3}$", "^\\d{1,}$", "^\\w+$", "^[^a]+$", "^a$",
+	                      "^(?:abc)$", "^(?:[a-z])+$", "^\\.", "\\x2d", "^[ab]$", "\xc3\xa9", "^\xc3\xa9",
+	                      "\xc3\xa9$", "^\xc3\xa9t\xc3\xa9$", "a^", "$a"})
+		expect_same_as_std(pattern, shaped_subjects);
+
+	// bytes of invalid UTF-8 are not a literal which could match inside a character
+	EXPECT_EQ(linear_regex("\x82").search("\xe2\x82\xac"), false);
+	EXPECT_EQ(linear_regex("\\ud800").search("\xed\xa0\x80"), false);
+
+	std::vector<std::size_t> shaped_matches;
+	linear_regex("^[a-z]+$").search_all("abc", shaped_matches);
+	EXPECT_EQ(shaped_matches.size(), 1);
+	linear_regex(std::vector<std::string>{"^prefix-"}).search_all("other", shaped_matches);
+	EXPECT_EQ(shaped_matches.size(), 0);
+
+	// std::regex does not know control escapes
+	EXPECT_EQ(linear_regex("\\cJ").search("a\nb"), true);
+
+	// code points, not bytes
+	EXPECT_EQ(linear_regex("^.$").search("\xc3\xa9"), true);
+	EXPECT_EQ(linear_regex("^[\\u00e0-\\u00ff]$").search("\xc3\xa9"), true);
+	EXPECT_EQ(linear_regex("^\\ud83d\\udc32$").search("\xf0\x9f\x90\xb2"), true);
+	EXPECT_EQ(linear_regex("^.$").search("\xff"), true); // invalid UTF-8 byte
+
+	// no backtracking
+	std::string long_subject(100000, 'a');
+	EXPECT_EQ(linear_regex("^(a+)+$").search(long_subject + "b"), false);
+	EXPECT_EQ(linear_regex("^(a|aa)*$").search(long_subject), true);
+	EXPECT_EQ(linear_regex("(a|b)*c").search(long_subject), false);
+	EXPECT_EQ(linear_regex("\\baa+\\b").search(long_subject), true);
+
+	// far more DFA-states than cached, the rest is simulated
+	linear_regex many_states("a[ab]{14}$");
+	EXPECT_EQ(many_states.search("a" + std::string(14, 'b')), true);
+	EXPECT_EQ(many_states.search(std::string(100, 'b') + "a" + std::string(14, 'b')), true);
+	EXPECT_EQ(many_states.search(std::string(14, 'b') + "a" + std::string(13, 'b')), false);
+	std::string mixed;
+	unsigned random = 1;
+	for (int i = 0; i < 100000; i++) {
+		random = random * 1103515245 + 12345;
+		mixed += (random >> 16) & 1 ? 'a' : 'b';
+	}
+	EXPECT_EQ(many_states.search(mixed), (mixed[mixed.size() - 15] == 'a'));
+
+	// a set tells all matching patterns in one scan
+	const std::vector<std::string> patterns{"^a", "b$", "\\d", "^[a-z]+$", "x", "^$", "a.*b", "\\bab"};
+	linear_regex set(patterns);
+	std::vector<linear_regex> singles;
+	for (auto &pattern : patterns)
+		singles.emplace_back(pattern);
+	for (auto &subject : subjects) {
+		std::vector<std::size_t> expected, matches;
+		for (std::size_t i = 0; i < singles.size(); i++)
+			if (singles[i].search(subject))
+				expected.push_back(i);
+		set.search_all(subject, matches);
+		if (matches != expected) {
+			std::cerr << "Failed: set on '" << subject << "'\n";
+			error_count++;
+		}
+		EXPECT_EQ(set.search(subject), !expected.empty());
+	}
+
+	std::vector<std::string> many_patterns;
+	for (int i = 0; i < 100; i++)
+		many_patterns.push_back("^key" + std::to_string(i) + "$");
+	linear_regex many(many_patterns);
+	std::vector<std::size_t> matches;
+	many.search_all("key42", matches);
+	EXPECT_EQ(matches.size(), 1);
+	EXPECT_EQ((matches.empty() ? 0 : matches[0]), 42);
+
+	EXPECT_EQ(unsupported("(a)\\1"), true);
+	EXPECT_EQ(unsupported("a(?=b)"), true);
+	EXPECT_EQ(unsupported("(?<name>a)"), true);
+	EXPECT_EQ(unsupported("\\p{L}"), true);
+	EXPECT_EQ(unsupported("a{2,1}"), true);
+	EXPECT_EQ(unsupported("(a"), true);
+	EXPECT_EQ(unsupported("a)"), true);
+	EXPECT_EQ(unsupported("*a"), true);
+	EXPECT_EQ(unsupported("[a"), true);
+	EXPECT_EQ(unsupported("a{1001}"), true);
+	EXPECT_EQ(unsupported("^[a-z]{1,1000}$"), false);
+
+	// patterns of schemas match code points, also those handed to std::regex:
+	// a leading lookahead, which always succeeds, forces the fallback
+	const std::string dragon = "\xf0\x9f\x90\xb2", e_acute = "\xc3\xa9";
+	std::vector<std::pair<std::string, std::vector<std::pair<std::string, bool>>>> cases{
+	    {"^.$", {{e_acute, true}, {"ab", false}}},
+	    {"^.{2}$", {{e_acute, false}, {e_acute + e_acute, true}, {"a" + e_acute, true}}},
+	    {"^[^x]$", {{e_acute, true}, {"x", false}}},
+	    {"^" + e_acute + "+$", {{e_acute + e_acute, true}, {"\xc3\xa9\xa9", false}}},
+	    {"^[a" + e_acute + "]{2}$", {{"a" + e_acute, true}, {e_acute, false}}},
+	};
+	if (sizeof(wchar_t) >= 4) // otherwise the fallback sees surrogate pairs
+		cases.push_back({"^.$", {{dragon, true}}});
+
+	for (auto &c : cases)
+		for (auto &pattern : {c.first, "(?=)" + c.first}) {
+			const bool fallback = pattern != c.first;
+			EXPECT_EQ(unsupported(pattern), fallback);
+			nlohmann::json_schema::json_validator validator(json{{"pattern", pattern}});
+			for (auto &subject : c.second)
+				if (validator.is_valid(subject.first) != subject.second) {
+					std::cerr << "Failed: /" << pattern << "/ on '" << subject.first << "'\n";
+					error_count++;
+				}
+		}
+
+	return error_count;
+}
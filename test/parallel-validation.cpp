@@ -0,0 +1,184 @@
+#include <nlohmann/json-schema.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+using nlohmann::json;
+using nlohmann::json_schema::json_validator;
+using nlohmann::json_schema::thread_pool;
+
+namespace
+{
+
+static int error_count;
+
+#define EXPECT_EQ(a, b)                                              \
+	do {                                                             \
+		if (a != b) {                                                \
+			std::cerr << "Failed: '" << a << "' != '" << b << "'\n"; \
+			error_count++;                                           \
+		}                                                            \
+	} while (0)
+
+class collecting_handler : public nlohmann::json_schema::basic_error_handler
+{
+public:
+	json errors = json::array();
+
+	void error(const json::json_pointer &ptr, const json &instance, const std::string &message) override
+	{
+		basic_error_handler::error(ptr, instance, message);
+		errors.push_back({ptr.to_string(), message});
+	}
+};
+
+json errors(const json_validator &validator, const json &instance)
+{
+	collecting_handler handler;
+	validator.validate(instance, handler);
+	return handler.errors;
+}
+
+const json schema = R"({
+    "type": "array",
+    "items": {
+        "type": "object",
+        "properties": {
+            "id": {"type": "integer", "minimum": 0},
+            "name": {"type": "string", "format": "hostname"},
+            "tags": {"type": "array", "items": {"type": "string", "maxLength": 3}},
+            "flag": {"type": "boolean", "default": false}
+        },
+        "propertyNames": {"maxLength": 4},
+        "patternProperties": {"^x": {"type": "number"}},
+        "additionalProperties": {"type": "null"}
+    }
+})"_json;
+
+// with the outcomes of the hostname-checks cached, shared by the threads
+void make(json_validator &validator)
+{
+	validator = json_validator(nullptr, nlohmann::json_schema::default_string_format_check);
+	validator.cache_format("hostname");
+	validator.set_root_schema(schema);
+}
+
+json documents(int n)
+{
+	json doc = json::array();
+	for (int i = 0; i < n; i++) {
+		json record = {{"id", i % 7 == 0 ? -i : i}, {"name", i % 5 == 0 ? "-bad" : "host"}};
+		json tags = json::array();
+		for (int t = 0; t < 50; t++)
+			tags.push_back(t % 13 == 0 && i % 3 == 0 ? "long" : "ok");
+		record["tags"] = tags;
+		if (i % 2)
+			record["flag"] = true;
+		if (i % 11 == 0)
+			record["too_long"] = nullptr;
+		if (i % 17 == 0)
+			record["x1"] = "a";
+		doc.push_back(record);
+	}
+	return doc;
+}
+
+} // namespace
+
+int main(void)
+{
+	const auto doc = documents(1000);
+
+	json_validator serial;
+	make(serial);
+	auto expected_errors = errors(serial, doc);
+	EXPECT_EQ(expected_errors.empty(), false);
+	EXPECT_EQ(serial.is_valid(doc), false);
+
+	// the same errors in the same order, the same default values, for all
+	// thresholds and for the arrays and objects nested in the items
+	auto pool = std::make_shared<thread_pool>(3);
+	for (std::size_t threshold : {1, 2, 10, 1000, 1001}) {
+		json_validator parallel;
+		make(parallel);
+		parallel.set_parallel(threshold, pool);
+
+		EXPECT_EQ(errors(parallel, doc), expected_errors);
+		EXPECT_EQ(parallel.is_valid(doc), false);
+		EXPECT_EQ(parallel.is_valid(R"([{"id": 1, "name": "host"}])"_json), true);
+
+		bool thrown = false;
+		try {
+			parallel.validate(doc);
+		} catch (const std::exception &) {
+			thrown = true;
+		}
+		EXPECT_EQ(thrown, true);
+	}
+
+	json defaults = json::array();
+	for (int i = 0; i < 1000; i++)
+		defaults.push_back({{"id", 1}});
+	json_validator parallel;
+	make(parallel);
+	parallel.set_parallel(8); // on a pool of the validator
+	EXPECT_EQ(parallel.validate(defaults), serial.validate(defaults));
+	EXPECT_EQ(parallel.validate(defaults).size(), 1000);
+
+	// exceptions of checkers are rethrown in the validating thread
+	json_validator throwing(
+	    R"({"items": {"format": "odd"}})"_json,
+	    nullptr,
+	    [](const std::string &, const std::string &value) {
+		    if (value == "boom")
+			    throw 42; // not turned into a format-error
+	    });
+	throwing.set_parallel(2, pool);
+	json strings = json::array();
+	for (int i = 0; i < 100; i++)
+		strings.push_back(i == 50 ? "boom" : "fine");
+	bool thrown = false;
+	try {
+		throwing.validate(strings);
+	} catch (int) {
+		thrown = true;
+	}
+	EXPECT_EQ(thrown, true);
+
+	// 0 validates serially again
+	throwing.set_parallel(0);
+	strings[50] = "fine";
+	EXPECT_EQ(errors(throwing, strings).size(), 0);
+
+	// nested calls on a pool of a single thread neither starve nor deadlock
+	thread_pool single(1);
+	std::atomic<int> calls{0};
+	single.parallel_for(4, [&](std::size_t) {
+		single.parallel_for(4, [&](std::size_t) { calls++; });
+	});
+	EXPECT_EQ(calls, 16);
+
+	// a caller whose remaining task runs on another thread sleeps until it is
+	// done instead of spinning - its CPU-time stays far below the wall-time
+	thread_pool sleeping(2);
+	const auto caller = std::this_thread::get_id();
+	std::atomic<bool> started{false};
+	std::clock_t cpu = std::clock();
+	sleeping.parallel_for(2, [&](std::size_t) {
+		if (std::this_thread::get_id() != caller) {
+			started = true;
+			std::this_thread::sleep_for(std::chrono::milliseconds(300));
+		} else
+			while (!started)
+				std::this_thread::yield();
+	});
+	bool slept = (std::clock() - cpu) * 1000 / CLOCKS_PER_SEC < 100;
+	EXPECT_EQ(slept, true);
+
+	return error_count;
+}
@@ -0,0 +1,101 @@
+#include <nlohmann/json-schema.hpp>
+
+#include <iostream>
+
+using nlohmann::json;
+using nlohmann::json_schema::json_validator;
+
+namespace
+{
+
+static int error_count;
+
+#define EXPECT_EQ(a, b)                                              \
+	do {                                                             \
+		if (a != b) {                                                \
+			std::cerr << "Failed: '" << a << "' != '" << b << "'\n"; \
+			error_count++;                                           \
+		}                                                            \
+	} while (0)
+
+class counting_handler : public nlohmann::json_schema::basic_error_handler
+{
+public:
+	int count = 0;
+
+	void error(const json::json_pointer &ptr, const json &instance, const std::string &message) override
+	{
+		basic_error_handler::error(ptr, instance, message);
+		count++;
+	}
+};
+
+int errors(const json_validator &validator, const json &instance)
+{
+	counting_handler handler;
+	validator.validate(instance, handler);
+	return handler.count;
+}
+
+json schema = R"({
+    "properties": {
+        "s_x": {"maxLength": 3},
+        "id": {"type": "integer"}
+    },
+    "patternProperties": {
+        "^s_": {"type": "string"},
+        "^i_": {"type": "integer"},
+        "^b_": {"type": "boolean"},
+        "^n_": {"type": "null"},
+        "^a_": {"type": "array"},
+        "^o_": {"type": "object"},
+        "_x$": {"minLength": 2},
+        "^(.)\\1_": {"type": "number"}
+    },
+    "additionalProperties": false
+})"_json;
+
+} // namespace
+
+int main(void)
+{
+	json good = R"({"id": 1, "s_1": "a", "i_2": 1, "b_3": true, "n_4": null, "a_5": [], "o_6": {}, "s_x": "ab", "zz_7": 1.5})"_json;
+	json bad = R"({"id": "1", "s_1": 1, "i_2": "a", "s_x": "a", "zz_7": "a", "unknown": 1})"_json;
+
+	json_validator uncached(schema);
+
+	// a cache smaller than the names seen, so that names are replaced
+	for (std::size_t entries : {0, 16, 4096}) {
+		json_validator validator;
+		validator.cache_object_keys(entries);
+		validator.set_root_schema(schema);
+
+		// the same names give the same results once their blocks are remembered
+		for (int i = 0; i < 3; i++) {
+			EXPECT_EQ(errors(validator, good), 0);
+			EXPECT_EQ(errors(validator, bad), 6);
+			EXPECT_EQ(validator.is_valid(good), true);
+			EXPECT_EQ(validator.is_valid(bad), false);
+		}
+
+		// more names than remembered
+		json many = json::object();
+		for (int i = 0; i < 1000; i++)
+			many["i_" + std::to_string(i)] = i;
+		for (int i = 0; i < 2; i++) {
+			EXPECT_EQ(errors(validator, many), 0);
+			many["i_" + std::to_string(i)] = "a";
+			EXPECT_EQ(errors(validator, many), 1);
+			EXPECT_EQ(errors(uncached, many), 1);
+			many["i_" + std::to_string(i)] = i;
+		}
+
+		// the members validated in parallel share the cache
+		validator.set_parallel(64);
+		many["unknown"] = 1;
+		for (int i = 0; i < 2; i++)
+			EXPECT_EQ(errors(validator, many), 1);
+	}
+
+	return error_count;
+}
@@ -0,0 +1,81 @@
+#include <nlohmann/json-schema.hpp>
+
+#include <iostream>
+
+using nlohmann::json;
+using nlohmann::json_schema::json_validator;
+
+namespace
+{
+
+static int error_count;
+
+#define EXPECT_EQ(a, b)                                              \
+	do {                                                             \
+		if (a != b) {                                                \
+			std::cerr << "Failed: '" << a << "' != '" << b << "'\n"; \
+			error_count++;                                           \
+		}                                                            \
+	} while (0)
+
+class collect : public nlohmann::json_schema::basic_error_handler
+{
+public:
+	std::vector<std::string> errors;
+	std::string innermost; // instance of the last error's innermost cause
+
+	void error(const json::json_pointer &ptr, const json &instance, const std::string &message) override
+	{
+		basic_error_handler::error(ptr, instance, message);
+		errors.push_back(ptr.to_string() + " " + instance.dump() + " " + message);
+	}
+
+	void error(const nlohmann::json_schema::error_record &record) override
+	{
+		auto cause = &record;
+		while (cause->cause())
+			cause = cause->cause();
+		innermost = cause->instance().dump();
+		nlohmann::json_schema::error_handler::error(record);
+	}
+};
+
+collect errors(const json &schema, const json &instance)
+{
+	json_validator validator;
+	validator.set_root_schema(schema);
+	collect e;
+	validator.validate(instance, e);
+	return e;
+}
+
+} // namespace
+
+int main(void)
+{
+	// errors of failed cases refer to the instance, they are reported after
+	// the cases have been validated
+	auto found = errors(R"({"anyOf": [{"properties": {"a": {"type": "string"}}}, {"properties": {"a": {"minimum": 2}}}]})"_json,
+	                    R"({"a": 1})"_json);
+	EXPECT_EQ(found.errors.size(), 3);
+	EXPECT_EQ(found.errors[1], "/a 1 [combination: anyOf / case#0] unexpected instance type");
+	EXPECT_EQ(found.errors[2], "/a 1 [combination: anyOf / case#1] instance is below minimum of 2");
+
+	// the names validated by propertyNames are not part of the instance, they
+	// are kept for the stored errors
+	found = errors(R"({"oneOf": [{"propertyNames": {"maxLength": 2}}, {"propertyNames": {"pattern": "^x"}}]})"_json,
+	               R"({"abc": 1})"_json);
+	EXPECT_EQ(found.errors.size(), 3);
+	EXPECT_EQ(found.errors[1], " \"abc\" [combination: oneOf / case#0] instance is too long as per maxLength: 2");
+	EXPECT_EQ(found.errors[2], " \"abc\" [combination: oneOf / case#1] instance does not match regex pattern: ^x");
+
+	// also when handed on through nested combinations and additionalProperties
+	found = errors(R"({"anyOf": [{"additionalProperties": {"allOf": [{"propertyNames": {"maxLength": 1}}]}}]})"_json,
+	               R"({"a": {"bc": 1}})"_json);
+	EXPECT_EQ(found.errors.size(), 2);
+	EXPECT_EQ(found.errors.back(), " {\"a\":{\"bc\":1}} [combination: anyOf / case#0] validation failed for additional property 'a': "
+	                        "at least one subschema has failed, but all of them are required to validate - instance is too long as per maxLength: 1");
+	EXPECT_EQ(found.innermost, "\"bc\"");
+
+	return error_count;
+}
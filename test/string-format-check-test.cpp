@@ -78,10 +78,56 @@ int main()
 	    {"255.256.255.255", false},
 	    {"256.255.255.255", false},
 	    {"256.256.256.256", false},
-	    {"0x7f000001", false}};
+	    {"0x7f000001", false},
+	    {"01.2.3.4", false},
+	    {"0.0.0.0", true}};
 
 	numberOfErrors += testStringFormat("ipv4", ipv4Checks);
 
+	const std::vector<std::pair<std::string, bool>> ipv6Checks{
+	    {"::", true},
+	    {"::1", true},
+	    {"fe80::", true},
+	    {"1:2:3:4:5:6:7:8", true},
+	    {"1:2:3:4:5:6:7::", true},
+	    {"1:2:3:4:5:6:192.168.0.1", true},
+	    {"::ffff:192.168.0.1", true},
+	    {"::ffff:192.168.0.01", false},
+	    {"1:2:3:4:5:6:7:192.168.0.1", false},
+	    {"1:2:3:4:5:6:7", false},
+	    {"1:2:3:4:5:6:7:8:9", false},
+	    {"1::2::3", false},
+	    {"1:::2", false},
+	    {"12345::", false},
+	    {":1::", false},
+	    {"1::2:", false},
+	    {"", false}};
+
+	numberOfErrors += testStringFormat("ipv6", ipv6Checks);
+
+	const std::vector<std::pair<std::string, bool>> hostnameChecks{
+	    {"example.com", true},
+	    {"a-b.c1", true},
+	    {std::string(63, 'x') + ".com", true},
+	    {std::string(64, 'x') + ".com", false},
+	    {"-a.com", false},
+	    {"a-.com", false},
+	    {"a..com", false},
+	    {"a.com.", false},
+	    {"ex_ample.com", false},
+	    {"", false}};
+
+	numberOfErrors += testStringFormat("hostname", hostnameChecks);
+
+	const std::vector<std::pair<std::string, bool>> uuidChecks{
+	    {"2eb8aa08-aa98-11ea-b4aa-73b441d16380", true},
+	    {"2EB8AA08-AA98-11EA-B4AA-73B441D16380", true},
+	    {"2eb8aa08-aa98-11ea-b4aa-73b441d1638", false},
+	    {"2eb8aa08aa98-11ea-b4aa-73b441d16380-", false},
+	    {"2eb8aa08-aa98-11ea-b4aa-73b441d1638g", false}};
+
+	numberOfErrors += testStringFormat("uuid", uuidChecks);
+
 	const std::vector<std::pair<std::string, bool>> uriChecks{
 	    {"http://www.google.com/search?q=regular%20expression", true},
 	    {"http://www.google.com/", true},
@@ -94,9 +140,104 @@ int main()
 	    {"https://john.doe@www.example.com:123/forum/questions/?tag=networking&order=newest#top", true},
 	    {"tel:+1-816-555-1212", true},
 	    {"telnet://192.0.2.16:80/", true},
-	    {"urn:oasis:names:specification:docbook:dtd:xml:4.1.2", true}};
+	    {"urn:oasis:names:specification:docbook:dtd:xml:4.1.2", true},
+	    {"http://[v1.fe:x]/", true},
+	    {"http://[::1", false},
+	    {"http://host:8x/", false},
+	    {"http://host/%2", false},
+	    {"1http://host/", false}};
 
 	numberOfErrors += testStringFormat("uri", uriChecks);
 
+	const std::vector<std::pair<std::string, bool>> uriReferenceChecks{
+	    {"http://www.google.com/", true},
+	    {"//www.google.com/search?q=x", true},
+	    {"/abc", true},
+	    {"abc/def:ghi", true},
+	    {"?q#f", true},
+	    {"", true},
+	    {"1abc:def", false},
+	    {"#frag\\ment", false},
+	    {"//host:8x/", false}};
+
+	numberOfErrors += testStringFormat("uri-reference", uriReferenceChecks);
+
+	const std::vector<std::pair<std::string, bool>> iriChecks{
+	    {"http://\xc6\x92\xc3\xb8\xc3\xb8.\xc3\x9f\xc3\xa5r/?\xe2\x88\x82=\xcf\x80#\xcf\x80", true},
+	    {"http://[2001:db8::7]/", true},
+	    {"/\xc3\xa2\xcf\x80", false},
+	    {"http://h/\xc3\xa9\\", false}};
+
+	numberOfErrors += testStringFormat("iri", iriChecks);
+
+	const std::vector<std::pair<std::string, bool>> iriReferenceChecks{
+	    {"/\xc3\xa2\xcf\x80", true},
+	    {"#\xc6\x92r\xc3\xa4g", true},
+	    {"\xc3\xa2:\xcf\x80", false}};
+
+	numberOfErrors += testStringFormat("iri-reference", iriReferenceChecks);
+
+	const std::vector<std::pair<std::string, bool>> uriTemplateChecks{
+	    {"http://example.com/dictionary/{term:1}/{term}", true},
+	    {"{+path*}/here{?x,y.z,%41}", true},
+	    {"{term:10000}", false},
+	    {"{term:0}", false},
+	    {"{a..b}", false},
+	    {"{}", false},
+	    {"{term", false},
+	    {"a b", false},
+	    {"x}", false}};
+
+	numberOfErrors += testStringFormat("uri-template", uriTemplateChecks);
+
+	const std::vector<std::pair<std::string, bool>> jsonPointerChecks{
+	    {"", true},
+	    {"/", true},
+	    {"/a~0b~1c/%/ ", true},
+	    {"/a~", false},
+	    {"/~2", false},
+	    {"a/b", false}};
+
+	numberOfErrors += testStringFormat("json-pointer", jsonPointerChecks);
+
+	const std::vector<std::pair<std::string, bool>> relativeJsonPointerChecks{
+	    {"0", true},
+	    {"10/a~1b", true},
+	    {"2#", true},
+	    {"01", false},
+	    {"-1", false},
+	    {"1##", false},
+	    {"1a", false}};
+
+	numberOfErrors += testStringFormat("relative-json-pointer", relativeJsonPointerChecks);
+
+	const std::vector<std::pair<std::string, bool>> idnHostnameChecks{
+	    {"example.com", true},
+	    {"\xec\x8b\xa4\xeb\xa1\x80.\xed\x85\x8c\xec\x8a\xa4\xed\x8a\xb8", true},
+	    {"xn--ihqwcrb4cv8a8dqg056pqjye", true},
+	    {"xn--X", false},
+	    {"XN--aa---o47jg78q", false},
+	    {"l\xc2\xb7l", true},
+	    {"a\xc2\xb7l", false},
+	    {"\xcc\x80hello", false},
+	    {"\xe3\x80\xaexy", false},
+	    {"a b", false},
+	    {"\xc3", false}};
+
+	numberOfErrors += testStringFormat("idn-hostname", idnHostnameChecks);
+
+	const std::vector<std::pair<std::string, bool>> regexChecks{
+	    {"^[a-z]+$", true},
+	    {"(a|b)*c", true},
+	    {"", true},
+	    {"(a", false},
+	    {"[a", false},
+	    {"a{2,1}", false},
+	    {"*a", false}};
+
+	// the second time from the remembered results
+	numberOfErrors += testStringFormat("regex", regexChecks);
+	numberOfErrors += testStringFormat("regex", regexChecks);
+
 	return numberOfErrors;
 }
@@ -0,0 +1,92 @@
+#include <nlohmann/json-schema.hpp>
+
+#include <iostream>
+
+using nlohmann::json;
+using nlohmann::json_schema::content_checker;
+using nlohmann::json_schema::format_checker;
+using nlohmann::json_schema::json_validator;
+
+namespace
+{
+
+static int error_count;
+
+#define EXPECT_EQ(a, b)                                              \
+	do {                                                             \
+		if (a != b) {                                                \
+			std::cerr << "Failed: '" << a << "' != '" << b << "'\n"; \
+			error_count++;                                           \
+		}                                                            \
+	} while (0)
+
+const json schema = R"({
+    "properties": {
+        "name": {"type": "string", "format": "lowercase"},
+        "data": {"contentEncoding": "base64", "contentMediaType": "text/plain"}
+    }
+})"_json;
+
+const json instance = R"({"name": "some-name", "data": "c29tZQ=="})"_json;
+const json bad_instance = R"({"name": "Some-Name", "data": "c29tZQ=="})"_json;
+
+// the address of the validated string, to see it was not copied
+const void *seen;
+
+bool valid(const json_validator &validator, const json &document)
+{
+	try {
+		validator.validate(document);
+	} catch (const std::exception &) {
+		return false;
+	}
+	return true;
+}
+
+} // namespace
+
+int main(void)
+{
+	const void *name = instance["name"].get_ref<const json::string_t &>().data();
+
+	// callables taking views
+	json_validator views(
+	    schema, nullptr,
+	    [](std::string_view format, std::string_view value) {
+		    seen = value.data();
+		    if (format == "lowercase" && value.find_first_of("ABCDEFGHIJKLMNOPQRSTUVWXYZ") != std::string_view::npos)
+			    throw std::invalid_argument("not lowercase");
+	    },
+	    [](std::string_view encoding, std::string_view media_type, const json &) {
+		    if (encoding != "base64" || media_type != "text/plain")
+			    throw std::invalid_argument("unexpected content");
+	    });
+	seen = nullptr;
+	EXPECT_EQ(valid(views, instance), true);
+	EXPECT_EQ((seen == name), true);
+	EXPECT_EQ(valid(views, bad_instance), false);
+
+	// callables taking strings, as checkers used to
+	json_validator strings(
+	    schema, nullptr,
+	    [](const std::string &format, const std::string &value) {
+		    seen = value.data();
+		    if (format == "lowercase" && value.find_first_of("ABCDEFGHIJKLMNOPQRSTUVWXYZ") != std::string::npos)
+			    throw std::invalid_argument("not lowercase");
+	    },
+	    [](const std::string &encoding, const std::string &media_type, const json &) {
+		    if (encoding != "base64" || media_type != "text/plain")
+			    throw std::invalid_argument("unexpected content");
+	    });
+	seen = nullptr;
+	EXPECT_EQ(valid(strings, instance), true);
+	EXPECT_EQ((seen == name), true);
+	EXPECT_EQ(valid(strings, bad_instance), false);
+
+	format_checker none;
+	EXPECT_EQ((none == nullptr), true);
+	EXPECT_EQ((format_checker(nlohmann::json_schema::default_string_format_check) != nullptr), true);
+	EXPECT_EQ((content_checker(nullptr) == nullptr), true);
+
+	return error_count;
+}
@@ -0,0 +1,67 @@
+#include <nlohmann/json-schema.hpp>
+
+#include <iostream>
+
+using nlohmann::json;
+using nlohmann::json_schema::json_validator;
+
+namespace
+{
+
+static int error_count;
+
+#define EXPECT_EQ(a, b)                                              \
+	do {                                                             \
+		if (a != b) {                                                \
+			std::cerr << "Failed: '" << a << "' != '" << b << "'\n"; \
+			error_count++;                                           \
+		}                                                            \
+	} while (0)
+
+class counting_handler : public nlohmann::json_schema::basic_error_handler
+{
+public:
+	int count = 0;
+
+	void error(const json::json_pointer &ptr, const json &instance, const std::string &message) override
+	{
+		basic_error_handler::error(ptr, instance, message);
+		count++;
+	}
+};
+
+int errors(const json_validator &validator, const json &instance)
+{
+	counting_handler handler;
+	validator.validate(instance, handler);
+	return handler.count;
+}
+
+} // namespace
+
+int main(void)
+{
+	json_validator validator(R"({"uniqueItems": true})"_json);
+
+	EXPECT_EQ(errors(validator, json::array()), 0);
+	EXPECT_EQ(errors(validator, {1, 2, 3}), 0);
+	EXPECT_EQ(errors(validator, {1, 2, 1.0}), 1);
+	EXPECT_EQ(errors(validator, {0, -0.0}), 1);
+	EXPECT_EQ(errors(validator, R"([{"a": [1, {"b": 2}]}, {"a": [1.0, {"b": 2.0}]}])"_json), 1);
+	EXPECT_EQ(errors(validator, R"([{"a": 1}, {"a": 1, "b": 1}])"_json), 0);
+
+	// a duplicate is reported once per array, whatever the number of equal items
+	EXPECT_EQ(errors(validator, {"x", "x", "x", "y", "y"}), 1);
+
+	json many = json::array();
+	for (int i = 0; i < 10000; i++)
+		many.push_back("id-" + std::to_string(i));
+	EXPECT_EQ(errors(validator, many), 0);
+	EXPECT_EQ(validator.is_valid(many), true);
+
+	many.push_back("id-42");
+	EXPECT_EQ(errors(validator, many), 1);
+	EXPECT_EQ(validator.is_valid(many), false);
+
+	return error_count;
+}
@@ -0,0 +1,86 @@
+#include "utf8-length.hpp"
+
+#include <iostream>
+
+using nlohmann::json_schema::string_length;
+using nlohmann::json_schema::utf8_length;
+
+namespace
+{
+
+static int error_count;
+
+#define EXPECT_EQ(a, b)                                              \
+	do {                                                             \
+		if (a != b) {                                                \
+			std::cerr << "Failed: '" << a << "' != '" << b << "'\n"; \
+			error_count++;                                           \
+		}                                                            \
+	} while (0)
+
+std::size_t scalar_length(const std::string &s)
+{
+	std::size_t length = 0;
+	for (auto c : s)
+		if ((c & 0xc0) != 0x80)
+			length++;
+	return length;
+}
+
+} // namespace
+
+int main(void)
+{
+	using nlohmann::json_schema::utf8_counting;
+	using nlohmann::json_schema::utf8_counting_supported;
+
+	// each way the build and the CPU support, not only the fastest
+	for (auto how : {utf8_counting::scalar, utf8_counting::sse2, utf8_counting::avx2}) {
+		if (!utf8_counting_supported(how)) {
+			std::cerr << "counting " << static_cast<int>(how) << " is not supported\n";
+			continue;
+		}
+
+		EXPECT_EQ(utf8_length("", how), 0);
+		EXPECT_EQ(utf8_length("abc", how), 3);
+		EXPECT_EQ(utf8_length("\xc3\xa9t\xc3\xa9", how), 3);
+		EXPECT_EQ(utf8_length("\xf0\x9f\x90\xb2", how), 1);
+
+		// all sizes around the vector widths and beyond 255 vectors, at every
+		// alignment, of random bytes
+		std::string bytes;
+		unsigned random = 1;
+		for (int i = 0; i < 20000; i++) {
+			random = random * 1103515245 + 12345;
+			bytes += static_cast<char>(random >> 16);
+		}
+		for (std::size_t offset = 0; offset < 32; offset++)
+			for (std::size_t size : {0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 4079, 4080, 4081, 8160, 8161, 16000}) {
+				std::string s = bytes.substr(offset, size);
+				EXPECT_EQ(utf8_length(s, how), scalar_length(s));
+			}
+
+		std::string text;
+		for (int i = 0; i < 3000; i++)
+			text += "a\xc3\xa9\xe2\x82\xac\xf0\x9f\x90\xb2"; // 4 code points of 1 to 4 bytes
+		EXPECT_EQ(utf8_length(text, how), 12000);
+	}
+
+	EXPECT_EQ(utf8_length("\xc3\xa9t\xc3\xa9"), 3);
+
+	// bounds decided by the number of bytes, or by counting
+	const std::string ab = "ab", two_wide = "\xc3\xa9\xc3\xa9";
+
+	string_length short_length(ab);
+	EXPECT_EQ(short_length.below(3), true);
+	EXPECT_EQ(short_length.below(0), false);
+	EXPECT_EQ(short_length.above(2), false);
+
+	string_length wide_length(two_wide);
+	EXPECT_EQ(wide_length.below(2), false);
+	EXPECT_EQ(wide_length.below(3), true);
+	EXPECT_EQ(wide_length.above(2), false);
+	EXPECT_EQ(wide_length.above(1), true);
+
+	return error_count;
+}